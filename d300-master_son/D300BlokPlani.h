@@ -0,0 +1,160 @@
+/*
+ * D300BlokPlani.h
+ * D-300 MK3 Modbus RTU Library for ESP32
+ * Blok okuma planlayıcı - register aralıklarını en az sayıda FC03 isteğine böler
+ *
+ * Derleme zamanında (D300RegisterMap.h grupları) ve çalışma zamanında
+ * (desteklenmeyen register'lar çıkarıldıktan sonra) aynı fonksiyon kullanılır.
+ */
+
+#ifndef D300_BLOK_PLANI_H
+#define D300_BLOK_PLANI_H
+
+#include <stdint.h>
+#include "D300ModbusRtu.h"
+
+// Blok okuma planı için register aralığı ve FC03 isteği
+struct RegisterAraligi {
+  uint16_t adres = 0;
+  uint8_t genislik = 0;   // 1 = 16 bit, 2 = 32 bit
+};
+
+struct BlokOkuma {
+  uint16_t baslangic = 0;
+  uint16_t adet = 0;
+};
+
+namespace D300Map {
+
+// Blok okuma ayarları
+static const uint16_t MAX_BLOK_REGISTER = D300ModbusRtu::MAX_REGISTER;   // FC03 sınırı
+static const uint16_t MAX_BLOK_BOSLUK = 20;     // Bu boşluğu okumak yeni bir istekten ucuz
+static const uint8_t MAX_PLAN_BLOK = 8;
+
+struct BlokPlani {
+  BlokOkuma blok[MAX_PLAN_BLOK] = {};
+  uint16_t ofset[MAX_PLAN_BLOK] = {};   // Her bloğun okuma tamponundaki yeri
+  uint8_t adet = 0;
+  uint16_t toplamRegister = 0;
+  bool tasti = false;                   // Aralıklar MAX_PLAN_BLOK bloğa sığmadı
+
+  constexpr int8_t blokIndeksi(uint16_t adres, uint8_t genislik) const {
+    for (uint8_t i = 0; i < adet; i++) {
+      if (adres >= blok[i].baslangic && adres + genislik <= blok[i].baslangic + blok[i].adet) {
+        return i;
+      }
+    }
+    return -1;
+  }
+};
+
+// Varsayılan: her boşluk okunabilir (derleme zamanı planları)
+struct HerBoslukOkunur {
+  constexpr bool operator()(uint16_t, uint16_t) const { return true; }
+};
+
+// Adres sırasına göre verilen aralıkları en az sayıda FC03 isteğine böler.
+// Aradaki boşluk MAX_BLOK_BOSLUK'u geçmiyorsa, blok MAX_BLOK_REGISTER'a
+// sığıyorsa ve boslukOkunur(bas, son) [bas, son) boşluğunun okunabildiğini
+// söylüyorsa aralık önceki bloğa eklenir; aksi halde yeni blok başlar.
+template <typename BoslukFiltresi = HerBoslukOkunur>
+constexpr BlokPlani planla(const RegisterAraligi* araliklar, uint8_t adet,
+                           BoslukFiltresi boslukOkunur = BoslukFiltresi()) {
+  BlokPlani plan;
+  for (uint8_t i = 0; i < adet; i++) {
+    uint16_t bas = araliklar[i].adres;
+    uint16_t son = bas + araliklar[i].genislik;
+
+    if (plan.adet > 0) {
+      BlokOkuma &blok = plan.blok[plan.adet - 1];
+      uint16_t blokSonu = blok.baslangic + blok.adet;
+      if (bas >= blok.baslangic && bas <= blokSonu + MAX_BLOK_BOSLUK &&
+          son - blok.baslangic <= MAX_BLOK_REGISTER &&
+          (bas <= blokSonu || boslukOkunur(blokSonu, bas))) {
+        if (son > blokSonu) {
+          plan.toplamRegister += son - blokSonu;
+          blok.adet = son - blok.baslangic;
+        }
+        continue;
+      }
+    }
+
+    if (plan.adet >= MAX_PLAN_BLOK) {
+      plan.tasti = true;
+      break;
+    }
+    plan.blok[plan.adet].baslangic = bas;
+    plan.blok[plan.adet].adet = araliklar[i].genislik;
+    plan.ofset[plan.adet] = plan.toplamRegister;
+    plan.toplamRegister += araliklar[i].genislik;
+    plan.adet++;
+  }
+  return plan;
+}
+
+// Ham register görüntüsü: okunan adres uzayı, aradaki küçük boşluklarla
+// birlikte parçalar halinde tek diziye dizilir. Parçalar planla() ile aynı
+// boşluk kuralıyla ama istek sınırı olmadan birleşir; bu yüzden aynı
+// aralıklardan (ya da alt kümesinden) çıkan her blok tek bir parçaya düşer
+// ve okuma doğrudan görüntüye yapılabilir.
+static const uint8_t MAX_GORUNTU_PARCA = 8;
+
+struct GoruntuDuzeni {
+  BlokOkuma parca[MAX_GORUNTU_PARCA] = {};
+  uint16_t ofset[MAX_GORUNTU_PARCA] = {};
+  uint8_t adet = 0;
+  uint16_t boyut = 0;
+  bool tasti = false;
+
+  // Aralığın görüntüdeki yeri; görüntü dışındaysa -1
+  constexpr int16_t ofsetBul(uint16_t adres, uint16_t genislik) const {
+    for (uint8_t i = 0; i < adet; i++) {
+      if (adres >= parca[i].baslangic && adres + genislik <= parca[i].baslangic + parca[i].adet) {
+        return ofset[i] + (adres - parca[i].baslangic);
+      }
+    }
+    return -1;
+  }
+
+  constexpr bool kapsar(const BlokPlani& plan) const {
+    for (uint8_t i = 0; i < plan.adet; i++) {
+      if (ofsetBul(plan.blok[i].baslangic, plan.blok[i].adet) < 0) return false;
+    }
+    return true;
+  }
+};
+
+constexpr GoruntuDuzeni goruntuPlanla(const RegisterAraligi* araliklar, uint8_t adet) {
+  GoruntuDuzeni duzen;
+  for (uint8_t i = 0; i < adet; i++) {
+    uint16_t bas = araliklar[i].adres;
+    uint16_t son = bas + araliklar[i].genislik;
+
+    if (duzen.adet > 0) {
+      BlokOkuma &parca = duzen.parca[duzen.adet - 1];
+      uint16_t parcaSonu = parca.baslangic + parca.adet;
+      if (bas >= parca.baslangic && bas <= parcaSonu + MAX_BLOK_BOSLUK) {
+        if (son > parcaSonu) {
+          duzen.boyut += son - parcaSonu;
+          parca.adet = son - parca.baslangic;
+        }
+        continue;
+      }
+    }
+
+    if (duzen.adet >= MAX_GORUNTU_PARCA) {
+      duzen.tasti = true;
+      break;
+    }
+    duzen.parca[duzen.adet].baslangic = bas;
+    duzen.parca[duzen.adet].adet = araliklar[i].genislik;
+    duzen.ofset[duzen.adet] = duzen.boyut;
+    duzen.boyut += araliklar[i].genislik;
+    duzen.adet++;
+  }
+  return duzen;
+}
+
+} // namespace D300Map
+
+#endif // D300_BLOK_PLANI_H
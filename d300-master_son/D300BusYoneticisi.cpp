@@ -0,0 +1,186 @@
+/*
+ * D300BusYoneticisi.cpp
+ * D-300 MK3 Modbus RTU Library for ESP32
+ * Implementation File - Çok üniteli hat yönetimi
+ */
+
+#include "D300BusYoneticisi.h"
+
+D300BusYoneticisi::D300BusYoneticisi(uint8_t rxPin, uint8_t txPin)
+  : edinimGorevi(nullptr), uniteSayisi(0) {
+  // RS485 TTL modülü otomatik flow control kullandığı için sadece RX/TX
+  modbusSerial = new HardwareSerial(2);
+  modbusSerial->begin(9600, SERIAL_8N1, rxPin, txPin);
+  busKilidi = xSemaphoreCreateRecursiveMutex();
+}
+
+D300Controller* D300BusYoneticisi::addUnit(uint8_t slaveID, uint8_t agirlik) {
+  if (uniteSayisi >= MAX_UNITE || findUnit(slaveID) != nullptr) return nullptr;
+
+  Unite &unite = uniteler[uniteSayisi++];
+  unite.kontrolcu = new D300Controller(bus, busKilidi, slaveID, &yakitSensoru);
+  unite.agirlik = agirlik ? agirlik : 1;
+  unite.mevcutAgirlik = 0;
+  unite.islemSayisi = 0;
+  return unite.kontrolcu;
+}
+
+D300Controller* D300BusYoneticisi::findUnit(uint8_t slaveID) const {
+  for (uint8_t i = 0; i < uniteSayisi; i++) {
+    if (uniteler[i].kontrolcu->getSlaveID() == slaveID) return uniteler[i].kontrolcu;
+  }
+  return nullptr;
+}
+
+void D300BusYoneticisi::setUnitWeight(uint8_t indeks, uint8_t agirlik) {
+  if (indeks < uniteSayisi) {
+    uniteler[indeks].agirlik = agirlik ? agirlik : 1;
+  }
+}
+
+uint8_t D300BusYoneticisi::begin(uint32_t baudRate, unsigned long updateInterval) {
+  uint32_t ilkBaud = baudRate == D300Controller::BAUD_OTOMATIK ? 9600 : baudRate;
+  modbusSerial->begin(ilkBaud, SERIAL_8N1);
+  bus.begin(*modbusSerial, ilkBaud);
+  delay(100); // Modüllerin hazırlanması için
+
+  // Şamandra tek zamanlayıcıyla örneklenir; üniteler aynı sensörü okur
+  yakitSensoru.begin();
+
+  // Hattaki tüm üniteler aynı hızda olmalı; ilk cevap veren ünite ile ölçülür
+  if (baudRate == D300Controller::BAUD_OTOMATIK) {
+    for (uint8_t i = 0; i < uniteSayisi; i++) {
+      if (uniteler[i].kontrolcu->negotiateBaud()) break;
+    }
+  }
+
+  uint8_t baglanan = 0;
+  for (uint8_t i = 0; i < uniteSayisi; i++) {
+    if (uniteler[i].kontrolcu->begin(bus.getBaudRate(), updateInterval)) {
+      baglanan++;
+    }
+  }
+  return baglanan;
+}
+
+int8_t D300BusYoneticisi::selectNextUnit() {
+  // Smooth weighted round-robin: sadece gönderecek bloğu olan üniteler yarışır
+  int8_t secilen = -1;
+  int16_t toplam = 0;
+  for (uint8_t i = 0; i < uniteSayisi; i++) {
+    if (!uniteler[i].kontrolcu->hasPendingBlock()) continue;
+    uniteler[i].mevcutAgirlik += uniteler[i].agirlik;
+    toplam += uniteler[i].agirlik;
+    if (secilen < 0 || uniteler[i].mevcutAgirlik > uniteler[secilen].mevcutAgirlik) {
+      secilen = i;
+    }
+  }
+  if (secilen >= 0) {
+    uniteler[secilen].mevcutAgirlik -= toplam;
+  }
+  return secilen;
+}
+
+void D300BusYoneticisi::runAcquisition() {
+  BusKilidi kilit(busKilidi);
+
+  // Tamamlanan işlem sahibi ünitenin callback'ine gider
+  bus.poll();
+
+  for (uint8_t i = 0; i < uniteSayisi; i++) {
+    D300Controller* unite = uniteler[i].kontrolcu;
+    unite->completeSteps();
+    unite->tickScheduler();
+  }
+
+  // Hat boşsa önce en acil komut, yoksa sırası gelen ünitenin tek bir bloğu gönderilir
+  if (!bus.isBusy()) {
+    int8_t komutlu = selectCommandUnit();
+    if (komutlu >= 0) {
+      if (uniteler[komutlu].kontrolcu->startNextCommand()) {
+        uniteler[komutlu].islemSayisi++;
+      }
+      return;
+    }
+    int8_t secilen = selectNextUnit();
+    if (secilen >= 0 && uniteler[secilen].kontrolcu->startNextBlock()) {
+      uniteler[secilen].islemSayisi++;
+    }
+  }
+}
+
+int8_t D300BusYoneticisi::selectCommandUnit() const {
+  // Komutlar ağırlıktan bağımsızdır; öncelik eşitse düşük indeksli ünite
+  int8_t secilen = -1;
+  int8_t enIyi = 0;
+  for (uint8_t i = 0; i < uniteSayisi; i++) {
+    int8_t oncelik = uniteler[i].kontrolcu->pendingCommandPriority();
+    if (oncelik >= 0 && (secilen < 0 || oncelik < enIyi)) {
+      secilen = i;
+      enIyi = oncelik;
+    }
+  }
+  return secilen;
+}
+
+void D300BusYoneticisi::acquisitionTask(void* arg) {
+  D300BusYoneticisi* self = static_cast<D300BusYoneticisi*>(arg);
+  for (;;) {
+    self->runAcquisition();
+    // Bir tik bekler; ünitelerin queueCommand() bildirimi görevi hemen uyandırır
+    ulTaskNotifyTake(pdTRUE, 1);
+  }
+}
+
+bool D300BusYoneticisi::startTask(uint8_t cekirdek, uint32_t yiginBoyutu, uint8_t oncelik) {
+  if (edinimGorevi != nullptr) return true;
+  if (xTaskCreatePinnedToCore(acquisitionTask, "d300_bus", yiginBoyutu, this,
+                              oncelik, &edinimGorevi, cekirdek) != pdPASS) {
+    return false;
+  }
+  // Üniteler komut eklediğinde bu görevi uyandırır
+  for (uint8_t i = 0; i < uniteSayisi; i++) {
+    uniteler[i].kontrolcu->edinimGorevi = edinimGorevi;
+  }
+  return true;
+}
+
+void D300BusYoneticisi::handle() {
+  // Görev yoksa edinim burada, loop() içinde yürür
+  if (edinimGorevi == nullptr) {
+    runAcquisition();
+  }
+  for (uint8_t i = 0; i < uniteSayisi; i++) {
+    uniteler[i].kontrolcu->refreshSnapshot();
+  }
+}
+
+uint8_t D300BusYoneticisi::getConnectedCount() const {
+  uint8_t adet = 0;
+  for (uint8_t i = 0; i < uniteSayisi; i++) {
+    if (uniteler[i].kontrolcu->getBaglantiDurumu()) adet++;
+  }
+  return adet;
+}
+
+String D300BusYoneticisi::getDataAsJSON() const {
+  String json;
+  char parca[128];
+  JsonYazici j(parca, sizeof(parca), [](void* baglam, const char* veri, size_t) {
+    *static_cast<String*>(baglam) += veri;
+  }, &json);
+  writeDataJson(j);
+  j.bitir();
+  return json;
+}
+
+void D300BusYoneticisi::writeDataJson(JsonYazici& j) const {
+  j.diziBasla();
+  for (uint8_t i = 0; i < uniteSayisi; i++) {
+    j.nesneBasla().alan("slaveID", uniteler[i].kontrolcu->getSlaveID());
+    j.anahtar("data");
+    uniteler[i].kontrolcu->writeDataJson(j);
+    j.nesneBitir();
+  }
+  j.diziBitir();
+}
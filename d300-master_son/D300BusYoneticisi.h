@@ -0,0 +1,73 @@
+/*
+ * D300BusYoneticisi.h
+ * D-300 MK3 Modbus RTU Library for ESP32
+ * Tek RS-485 hattı üzerinde birden fazla D-300 ünitesini okur
+ *
+ * Seri port, Modbus RTU durum makinesi ve edinim görevi yöneticiye aittir.
+ * Her ünite kendi veri görüntüsünü, zamanlayıcısını ve bağlantı durumunu
+ * tutan bir D300Controller'dır. Hat boşaldığında sırası gelen ünitenin bir
+ * sonraki bloğu gönderilir (ağırlıklı round-robin); hiçbir ünite diğerlerini
+ * kendi turunun sonuna kadar bekletmez. Bekleyen kontrol komutları ağırlıktan
+ * bağımsız olarak, öncelik sırasıyla okuma bloklarından önce gönderilir.
+ */
+
+#ifndef D300_BUS_YONETICISI_H
+#define D300_BUS_YONETICISI_H
+
+#include "D300Controller.h"
+
+class D300BusYoneticisi {
+public:
+  static const uint8_t MAX_UNITE = 8;
+
+  D300BusYoneticisi(uint8_t rxPin = 16, uint8_t txPin = 17);
+
+  // Üniteler begin() öncesinde eklenir; ağırlık hat payını belirler (1 = eşit)
+  D300Controller* addUnit(uint8_t slaveID, uint8_t agirlik = 1);
+
+  // Hattı başlatır ve her üniteye bağlantı testi yapar; bağlanan ünite sayısını döner.
+  // baudRate = D300Controller::BAUD_OTOMATIK hattın hızını ilk cevap veren üniteyle bulur.
+  uint8_t begin(uint32_t baudRate = 9600, unsigned long updateInterval = 250);
+  void handle();
+  bool startTask(uint8_t cekirdek = 0, uint32_t yiginBoyutu = 4096, uint8_t oncelik = 2);
+
+  // Ünite erişimi
+  uint8_t getUnitCount() const { return uniteSayisi; }
+  D300Controller* getUnit(uint8_t indeks) const { return indeks < uniteSayisi ? uniteler[indeks].kontrolcu : nullptr; }
+  D300Controller* findUnit(uint8_t slaveID) const;
+  void setUnitWeight(uint8_t indeks, uint8_t agirlik);
+
+  // Sağlık durumu
+  uint8_t getConnectedCount() const;
+  uint32_t getIslemSayisi(uint8_t indeks) const { return indeks < uniteSayisi ? uniteler[indeks].islemSayisi : 0; }
+
+  // Tüm ünitelerin verisi tek JSON dizisinde
+  String getDataAsJSON() const;
+  void writeDataJson(JsonYazici& j) const;
+
+  // Kartın harici şamandrası; tüm ünitelerle paylaşılır
+  float getHariciYakitSeviyesi() const { return yakitSensoru.getSeviye(); }
+
+private:
+  struct Unite {
+    D300Controller* kontrolcu;
+    uint8_t agirlik;
+    int16_t mevcutAgirlik;       // Smooth weighted round-robin sayacı
+    uint32_t islemSayisi;        // Bu üniteye verilen hat işlemi
+  };
+
+  HardwareSerial* modbusSerial;
+  D300ModbusRtu bus;
+  SemaphoreHandle_t busKilidi;
+  D300YakitSensoru yakitSensoru;  // Karta ait; hattaki ünite sayısından bağımsız tek örnekleyici
+  TaskHandle_t edinimGorevi;
+  Unite uniteler[MAX_UNITE];
+  uint8_t uniteSayisi;
+
+  void runAcquisition();
+  int8_t selectNextUnit();
+  int8_t selectCommandUnit() const;
+  static void acquisitionTask(void* arg);
+};
+
+#endif // D300_BUS_YONETICISI_H
@@ -5,62 +5,201 @@
  */
 
 #include "D300Controller.h"
+#include "D300RegisterMap.h"
+#include "D300Sema.h"
+#include <Preferences.h>
+#include <limits.h>
+
+// Varsayılan okuma periyotları (ms) ve fazları (slot).
+// Fazlar yavaş grupları farklı slotlara dağıtır.
+static const struct {
+  unsigned long periyot;
+  uint16_t faz;
+} VARSAYILAN_POLL_ZAMANLARI[] = {
+  {250, 0},       // Elektrik
+  {1000, 1},      // Motor
+  {0, 0},         // Durum - her slotta
+  {60000, 2},     // Sayac
+  {60000, 3},     // Analog
+  {300000, 5}     // GPSIletisim
+};
+static_assert(sizeof(VARSAYILAN_POLL_ZAMANLARI) / sizeof(VARSAYILAN_POLL_ZAMANLARI[0]) ==
+              static_cast<uint8_t>(PollGrubu::ADET), "Her poll grubu için varsayılan zaman gerekli");
+
+// Varsayılan bağıl ölü bantlar (binde); sayaç, durum ve kimlikler her değişimde bildirilir
+static const uint16_t VARSAYILAN_OLU_BANT_BINDE[] = {
+  5,      // Elektrik (%0.5)
+  10,     // Motor (%1)
+  0,      // Durum
+  0,      // Sayac
+  10,     // Analog
+  0       // GPSIletisim
+};
+static_assert(sizeof(VARSAYILAN_OLU_BANT_BINDE) / sizeof(VARSAYILAN_OLU_BANT_BINDE[0]) ==
+              static_cast<uint8_t>(PollGrubu::ADET), "Her poll grubu için varsayılan ölü bant gerekli");
+
+// write*Json çıktısını String'e toplar; eski String API'si için
+template <typename F>
+static String jsonMetni(F yazdir) {
+  String json;
+  json.reserve(512);
+  char parca[128];
+  JsonYazici j(parca, sizeof(parca), [](void* baglam, const char* veri, size_t) {
+    *static_cast<String*>(baglam) += veri;
+  }, &json);
+  yazdir(j);
+  j.bitir();
+  return json;
+}
 
 // Constructor
 D300Controller::D300Controller(uint8_t slaveID, uint8_t rxPin, uint8_t txPin) 
-  : slaveID(slaveID), lastUpdateTime(0), updateInterval(5000), autoUpdate(true), 
-    connectionStatus(false), consecutiveErrors(0) {
+  : slaveID(slaveID), lastUpdateTime(0), updateInterval(250), lastSlotTime(0), slotSayaci(0),
+    autoUpdate(true), connectionStatus(false), consecutiveErrors(0), baglantiSkoru(0.0f),
+    sonBasariliIslem(0), sonIslem(0), alarmCallback(nullptr),
+    kuyrukBas(0), kuyrukAdet(0), aktifBlok(0), blokBekleniyor(false), sonAdimBasarili(false),
+    aktifKomut(-1), komutSirasi(0),
+    yayinSira(0), yerelSira(0), okumaNesli(0), degisimNesli(0), edinimGorevi(nullptr), busKilidi(nullptr) {
   
   // RS485 TTL modülü otomatik flow control kullandığı için sadece RX/TX
   modbusSerial = new HardwareSerial(2);
   modbusSerial->begin(9600, SERIAL_8N1, rxPin, txPin);
+  bus = new D300ModbusRtu();
+  yakitSensoru = new D300YakitSensoru();
+  yonetimli = false;
+  
+  initCommon();
+}
 
-    // ADC pin konfigürasyonu
-  pinMode(FUEL_ADC_PIN, INPUT);
-  analogReadResolution(12);  // 12-bit ADC çözünürlük
+D300Controller::D300Controller(D300ModbusRtu& paylasilanBus, SemaphoreHandle_t kilit, uint8_t slaveID,
+                               D300YakitSensoru* yakitSensoru)
+  : slaveID(slaveID), lastUpdateTime(0), updateInterval(250), lastSlotTime(0), slotSayaci(0),
+    autoUpdate(true), connectionStatus(false), consecutiveErrors(0), baglantiSkoru(0.0f),
+    sonBasariliIslem(0), sonIslem(0), alarmCallback(nullptr),
+    kuyrukBas(0), kuyrukAdet(0), aktifBlok(0), blokBekleniyor(false), sonAdimBasarili(false),
+    aktifKomut(-1), komutSirasi(0),
+    yayinSira(0), yerelSira(0), okumaNesli(0), degisimNesli(0), edinimGorevi(nullptr), busKilidi(kilit),
+    yakitSensoru(yakitSensoru) {
+  
+  // Seri port, hat, zamanlama ve yakıt sensörü yöneticiye aittir
+  modbusSerial = nullptr;
+  bus = &paylasilanBus;
+  yonetimli = true;
+  
+  initCommon();
+}
+
+static int16_t registerIndeksi(uint16_t adres);
+
+void D300Controller::initCommon() {
+  memset(cozulenNesil, 0, sizeof(cozulenNesil));
+  memset(alarmBitleri, 0, sizeof(alarmBitleri));
+  memset(komutlar, 0, sizeof(komutlar));
+  memset(&onay, 0, sizeof(onay));
+  iptalOnayAdet = 0;
+  memset(&tarama, 0, sizeof(tarama));
+  nominalGucKw[0] = 0.0f;
+  nominalGucKw[1] = 0.0f;
+  tarama.kanalMaskesi = TUM_HARMONIK_KANALLARI;
+  tarama.kanalAraligiMs = 1000;
+  tarama.yerlesmeMs = 500;
+  
+  for (uint8_t i = 0; i < POLL_GRUP_SAYISI; i++) {
+    pollZamani[i].periyot = VARSAYILAN_POLL_ZAMANLARI[i].periyot;
+    pollZamani[i].faz = VARSAYILAN_POLL_ZAMANLARI[i].faz;
+    pollZamani[i].sonrakiSlot = VARSAYILAN_POLL_ZAMANLARI[i].faz;
+  }
+  
+  // Yoklamaya kadar tüm register'lar okunur
+  for (uint8_t i = 0; i < MAX_HARITA_REGISTER; i++) {
+    registerDestegi[i] = RegisterDestegi::Bilinmiyor;
+    boslukDestegi[i] = RegisterDestegi::Bilinmiyor;
+  }
+  rebuildPlans();
+  
+  // Bayatlık sınırı alanın kendi grubunun periyodundan hesaplanır
+  assignFieldGroup<D300Map::ElektrikRegisterlari>(PollGrubu::Elektrik);
+  assignFieldGroup<D300Map::MotorRegisterlari>(PollGrubu::Motor);
+  assignFieldGroup<D300Map::DurumRegisterlari>(PollGrubu::Durum);
+  assignFieldGroup<D300Map::SayacRegisterlari>(PollGrubu::Sayac);
+  assignFieldGroup<D300Map::AnalogRegisterlari>(PollGrubu::Analog);
+  assignFieldGroup<D300Map::GPSIletisimRegisterlari>(PollGrubu::GPSIletisim);
+  
+  // Değişim algılama: ölçüm gürültüsü olan gruplara bağıl ölü bant
+  memset(oluBantMutlak, 0, sizeof(oluBantMutlak));
+  memset(bildirilenHam, 0, sizeof(bildirilenHam));
+  memset(bildirilenAlarmlar, 0, sizeof(bildirilenAlarmlar));
+  memset(alanDegisimNesli, 0, sizeof(alanDegisimNesli));
+  memset(kirliBitler, 0, sizeof(kirliBitler));
+  for (uint8_t i = 0; i < D300Map::TumRegisterlar::alanSayisi; i++) {
+    oluBantBinde[i] = VARSAYILAN_OLU_BANT_BINDE[alanGrubu[i]];
+  }
 }
 
 bool D300Controller::begin(uint32_t baudRate, unsigned long updateInterval) {
   this->updateInterval = updateInterval;
   
-  // Serial bağlantısını başlat
-  modbusSerial->begin(baudRate, SERIAL_8N1);
-  
-  // Modbus konfigürasyonu
-  node.begin(slaveID, *modbusSerial);
+  // Paylaşılan hatta seri port yönetici tarafından başlatılır
+  if (!yonetimli) {
+    // Serial bağlantısını başlat; otomatik modda tarama 9600'den başlar
+    uint32_t ilkBaud = baudRate == BAUD_OTOMATIK ? 9600 : baudRate;
+    modbusSerial->begin(ilkBaud, SERIAL_8N1);
+    
+    // Modbus konfigürasyonu
+    bus->begin(*modbusSerial, ilkBaud);
+    if (busKilidi == nullptr) {
+      busKilidi = xSemaphoreCreateRecursiveMutex();
+    }
+    
+    delay(100); // Modülün hazırlanması için
+    
+    if (baudRate == BAUD_OTOMATIK && negotiateBaud() == 0) {
+      connectionStatus = false;
+      return false;
+    }
+  }
   
-  delay(100); // Modülün hazırlanması için
+  // Şamandra örneklemesi hattan bağımsızdır; bağlantı kurulamasa da çalışır.
+  // Paylaşılan hatta sensörü yönetici bir kez başlatır.
+  if (!yonetimli) {
+    yakitSensoru->begin();
+  }
   
   // İlk bağlantı testi
-  connectionStatus = isConnected();
-  if (connectionStatus) {
-    resetErrorCounter();
+  if (probeLink()) {
+    probeRegisterSupport();
     return updateBasicData();
   }
   
   return false;
 }
 
+uint32_t D300Controller::negotiateBaud(bool zorla) {
+  // Ölçüm, normal çalışmadaki en büyük blokla yapılır; kısa bir
+  // okumada geçen ama uzun çerçevede bozulan hız seçilmez
+  const BlokOkuma &blok = planlar[PLAN_TEMEL].blok[0];
+  
+  BusKilidi kilit(busKilidi);
+  uint32_t secilen = bus->negotiateBaud(slaveID, blok.baslangic, blok.adet, zorla);
+  if (secilen) {
+    Serial.printf("D-300 #%u hat hızı: %lu baud\n", slaveID, (unsigned long)secilen);
+  } else {
+    Serial.printf("D-300 #%u hiçbir hızda cevap vermedi\n", slaveID);
+  }
+  return secilen;
+}
+
 bool D300Controller::read32BitValue(uint16_t address, uint32_t &value) {
-  uint8_t result = node.readHoldingRegisters(address, 2);
-  if (result == node.ku8MBSuccess) {
-    value = ((uint32_t)node.getResponseBuffer(0) << 16) | node.getResponseBuffer(1);
-    resetErrorCounter();
+  uint16_t reg[2];
+  if (readMultipleRegisters(address, 2, reg)) {
+    value = ((uint32_t)reg[0] << 16) | reg[1];
     return true;
   }
-  handleError();
   return false;
 }
 
 bool D300Controller::read16BitValue(uint16_t address, uint16_t &value) {
-  uint8_t result = node.readHoldingRegisters(address, 1);
-  if (result == node.ku8MBSuccess) {
-    value = node.getResponseBuffer(0);
-    resetErrorCounter();
-    return true;
-  }
-  handleError();
-  return false;
+  return readMultipleRegisters(address, 1, &value);
 }
 
 bool D300Controller::readFloat32(uint16_t address, float &value, int coefficient) {
@@ -81,265 +220,1344 @@ bool D300Controller::readFloat16(uint16_t address, float &value, int coefficient
   return false;
 }
 
+bool D300Controller::readMultipleRegisters(uint16_t address, uint16_t quantity, uint16_t* buffer) {
+  // Bloklayan okuma; devam eden asenkron istek önce tamamlanır
+  BusKilidi kilit(busKilidi);
+  ModbusSonuc sonuc = bus->readHoldingRegisters(slaveID, address, quantity, buffer);
+  recordResult(sonuc);
+  return sonuc == ModbusSonuc::Basarili;
+}
+
+void D300Controller::recordResult(ModbusSonuc sonuc) {
+  sonIslem = millis();
+  
+  // İstisna cevabı hattın sağlam olduğunu gösterir, bağlantı hatası sayılmaz
+  if (sonuc == ModbusSonuc::Basarili || D300ModbusRtu::isIstisna(sonuc)) {
+    resetErrorCounter();
+  } else {
+    handleError();
+  }
+}
+
 void D300Controller::handleError() {
-  consecutiveErrors++;
-  if (consecutiveErrors >= MAX_ERRORS) {
+  baglantiSkoru -= baglantiSkoru * SKOR_KATSAYISI;
+  if (consecutiveErrors < 255) consecutiveErrors++;
+  
+  // Art arda hatalar ya da seyrek başarılarla düşen skor bağlantıyı keser
+  if (consecutiveErrors >= MAX_ERRORS || baglantiSkoru < MIN_BAGLANTI_SKORU) {
     connectionStatus = false;
   }
 }
 
 void D300Controller::resetErrorCounter() {
+  baglantiSkoru += (1.0f - baglantiSkoru) * SKOR_KATSAYISI;
   consecutiveErrors = 0;
+  sonBasariliIslem = millis();
+  
+  // Uzun bir kopukluktan sonra ilk cevap bağlantıyı hemen geri getirir
+  if (baglantiSkoru < MIN_BAGLANTI_SKORU) {
+    baglantiSkoru = MIN_BAGLANTI_SKORU;
+  }
   connectionStatus = true;
 }
 
-void D300Controller::updateElektrikselVeriler() {
-  // Şebeke voltajları
-  readFloat32(10240, ElektrikSistemi.Sebeke.L1.Voltaj, 10);
-  readFloat32(10242, ElektrikSistemi.Sebeke.L2.Voltaj, 10);
-  readFloat32(10244, ElektrikSistemi.Sebeke.L3.Voltaj, 10);
-  
-  // Jeneratör voltajları
-  readFloat32(10246, ElektrikSistemi.Jenerator.L1.Voltaj, 10);
-  readFloat32(10248, ElektrikSistemi.Jenerator.L2.Voltaj, 10);
-  readFloat32(10250, ElektrikSistemi.Jenerator.L3.Voltaj, 10);
-  
-  // Akımlar
-  readFloat32(10264, ElektrikSistemi.Sebeke.L1.Akim, 10);
-  readFloat32(10266, ElektrikSistemi.Sebeke.L2.Akim, 10);
-  readFloat32(10268, ElektrikSistemi.Sebeke.L3.Akim, 10);
-  readFloat32(10270, ElektrikSistemi.Jenerator.L1.Akim, 10);
-  readFloat32(10272, ElektrikSistemi.Jenerator.L2.Akim, 10);
-  readFloat32(10274, ElektrikSistemi.Jenerator.L3.Akim, 10);
-  
-  // Güç verileri
-  readFloat32(10292, ElektrikSistemi.Sebeke.Toplam.AktifGuc, 10);
-  readFloat32(10294, ElektrikSistemi.Jenerator.Toplam.AktifGuc, 10);
-  readFloat32(10308, ElektrikSistemi.Sebeke.Toplam.ReaktifGuc, 10);
-  readFloat32(10310, ElektrikSistemi.Jenerator.Toplam.ReaktifGuc, 10);
-  
-  // Frekanslar
-  readFloat16(10338, ElektrikSistemi.Sebeke.Frekans, 100);
-  readFloat16(10339, ElektrikSistemi.Jenerator.Frekans, 100);
-  
-  // Ortalama değerler
-  readFloat32(10377, ElektrikSistemi.Jenerator.Toplam.OrtalamaVoltaj, 10);
-  readFloat32(10379, ElektrikSistemi.Jenerator.Toplam.OrtalamaAkim, 10);
-  readFloat32(10381, ElektrikSistemi.Sebeke.Toplam.OrtalamaVoltaj, 10);
-  readFloat32(10383, ElektrikSistemi.Sebeke.Toplam.OrtalamaAkim, 10);
-}
-
-// updateMotorVerileri() fonksiyonunu güncelleyin:
-void D300Controller::updateMotorVerileri() {
-  // Mevcut D-300 verileri
-  readFloat16(10376, Motor.RPM, 1);
-  readFloat16(10362, Motor.Sicaklik, 10);
-  readFloat16(10361, Motor.YagBasinci, 10);
-  readFloat16(10363, Motor.YakitSeviyesi, 10);  // D-300'den gelen
-  readFloat16(10364, Motor.YagSicakligi, 10);
-  readFloat16(10365, Motor.KanopyicSicaklik, 10);
-  readFloat16(10366, Motor.OrtamSicakligi, 10);
-  readFloat16(10341, Motor.BataryaVoltaji, 100);
-  readFloat16(10385, Motor.MinBataryaVoltaji, 100);
-  readFloat16(10340, Motor.SarjVoltaji, 100);
-  readFloat16(11173, Motor.SarjAkimi, 10);
-  
-  // Harici yakıt sensörü okuma
-  Motor.HariciYakitSeviyesi = readFuelADC();
-}
-void D300Controller::updateSistemDurumu() {
-  uint16_t durum, mod;
-  if (read16BitValue(10604, durum)) {
-    Sistem.Durum = static_cast<UniteDurumu>(durum);
-  }
-  
-  if (read16BitValue(10605, mod)) {
-    Sistem.Mod = static_cast<UniteModu>(mod);
-  }
-  
-  read16BitValue(10606, Sistem.OperasyonZamanlayici);
-  readFloat16(10607, Sistem.GOVKontrolCikis, 10);
-  readFloat16(10608, Sistem.AVRKontrolCikis, 10);
-  read16BitValue(10609, Sistem.CihazKimlik);
-  read16BitValue(10610, Sistem.DonanımVersiyon);
-  read16BitValue(10611, Sistem.YazilimVersiyon);
-}
-
-void D300Controller::updateSayaclar() {
-  read32BitValue(10616, Sayac.JeneratorCalismaAdedi);
-  read32BitValue(10618, Sayac.JeneratorMarsAdedi);
-  read32BitValue(10620, Sayac.JeneratorYukluCalisma);
-  readFloat32(10622, Sayac.MotorCalismaSaati, 100);
-  readFloat32(10624, Sayac.SonServistenBeriSaat, 100);
-  readFloat32(10626, Sayac.SonServistenBeriGun, 100);
-  readFloat32(10628, Sayac.ToplamAktifEnerji, 10);
-  readFloat32(10630, Sayac.ToplamReaktifEnerjiInd, 10);
-  readFloat32(10632, Sayac.ToplamReaktifEnerjiCap, 10);
-  readFloat32(11577, Sayac.YakitSayaci, 10);
-}
-
-void D300Controller::updateAnalogGirisler() {
-  read16BitValue(10345, AnalogGiris.Analog1Ohm);
-  read16BitValue(10346, AnalogGiris.Analog2Ohm);
-  read16BitValue(10347, AnalogGiris.Analog3Ohm);
-  read16BitValue(10348, AnalogGiris.Analog4Ohm);
-  read16BitValue(10349, AnalogGiris.Analog5Ohm);
-  read16BitValue(10350, AnalogGiris.Analog6Ohm);
-  read16BitValue(10351, AnalogGiris.Analog7Deger);
-  read16BitValue(10352, AnalogGiris.Analog8Deger);
-}
-
-void D300Controller::updateAlarmDurumlari() {
-  uint16_t tempValue;
-  
-  // Kapatma alarmları kontrolü
-  Sistem.KapatmaAlarmi = false;
-  for (uint16_t addr = 10504; addr <= 10519; addr++) {
-    if (read16BitValue(addr, tempValue) && tempValue != 0) {
-      Sistem.KapatmaAlarmi = true;
-      break;
+bool D300Controller::probeLink() {
+  {
+    BusKilidi kilit(busKilidi);
+    enqueueStep(&D300Map::KIMLIK_PLANI, &D300Controller::processIdentity);
+    drainReads();
+  }
+  return connectionStatus;
+}
+
+void D300Controller::processIdentity(const D300Map::BlokPlani& plan, const bool* blokGecerli) {
+  if (!blokGecerli[0]) return;
+  
+  // Cevap veren cihaz bir D-300/500/700 değilse hat sağlam ama ünite yanlış
+  uint16_t kimlik = arka.Ham[D300Map::GORUNTU.ofsetBul(D300Map::KIMLIK_ADRESI, 1)];
+  if (kimlik != 0xD300 && kimlik != 0xD500 && kimlik != 0xD700) {
+    recordResult(ModbusSonuc::GecersizCevap);
+  }
+}
+
+// Asenkron okuma kuyruğu
+bool D300Controller::enqueueStep(const D300Map::BlokPlani* plan, AdimIsleyici isle) {
+  static_assert(D300Map::MAX_PLAN_BLOK <= MAX_ADIM_BLOK, "Blok planı adım tamponuna sığmıyor");
+  
+  if (kuyrukAdet >= MAX_OKUMA_ADIMI) return false;
+  OkumaAdimi &adim = okumaKuyrugu[(kuyrukBas + kuyrukAdet) % MAX_OKUMA_ADIMI];
+  adim.plan = plan;
+  adim.isle = isle;
+  kuyrukAdet++;
+  return true;
+}
+
+template <typename Grup>
+bool D300Controller::enqueueRead(uint8_t planNo) {
+  return enqueueStep(&planlar[planNo], &D300Controller::commitGroup<Grup>);
+}
+
+template <typename Grup>
+void D300Controller::commitGroup(const D300Map::BlokPlani& plan, const bool* blokGecerli) {
+  // Değerler zaten ham görüntüde; sadece kalite ve grup nesilleri güncellenir
+  markFields<Grup>(plan);
+}
+
+template <typename Grup>
+void D300Controller::markFields(const D300Map::BlokPlani& plan) {
+  // Plandaki her alan kendi bloğunun sonucunu alır; plan dışı alanlar Yok kalır
+  unsigned long simdi = millis();
+  for (uint8_t i = 0; i < Grup::alanSayisi; i++) {
+    const RegisterAraligi &alan = Grup::sirali.a[i];
+    int8_t b = plan.blokIndeksi(alan.adres, alan.genislik);
+    int16_t indeks = registerIndeksi(alan.adres);
+    if (b >= 0 && indeks >= 0) {
+      markField(indeks, blokSonuc[b], simdi);
     }
   }
+}
+
+void D300Controller::markField(uint8_t indeks, ModbusSonuc sonuc, unsigned long zaman) {
+  AlanMetaVerisi &meta = arka.Meta;
+  if (sonuc == ModbusSonuc::Basarili) {
+    meta.Kalite[indeks] = AlanKalitesi::Iyi;
+    meta.Zaman[indeks] = zaman;
+    
+    // Okuyucu bu grubu bir sonraki yenilemede yeniden çözer
+    uint8_t grup = indeks == ALARM_META_INDEKSI ? static_cast<uint8_t>(PollGrubu::Durum) : alanGrubu[indeks];
+    arka.GrupNesli[grup] = okumaNesli;
+  } else if (D300ModbusRtu::isIstisna(sonuc)) {
+    meta.Kalite[indeks] = AlanKalitesi::Istisna;
+  } else if (sonuc == ModbusSonuc::ZamanAsimi) {
+    meta.Kalite[indeks] = AlanKalitesi::ZamanAsimi;
+  } else {
+    meta.Kalite[indeks] = AlanKalitesi::Hata;
+  }
+}
+
+template <typename Grup>
+void D300Controller::assignFieldGroup(PollGrubu grup) {
+  for (uint8_t i = 0; i < Grup::alanSayisi; i++) {
+    int16_t indeks = registerIndeksi(Grup::sirali.a[i].adres);
+    if (indeks >= 0) alanGrubu[indeks] = static_cast<uint8_t>(grup);
+  }
+}
+
+unsigned long D300Controller::staleLimit(uint8_t indeks) const {
+  uint8_t grup = indeks == ALARM_META_INDEKSI ? static_cast<uint8_t>(PollGrubu::Durum) : alanGrubu[indeks];
+  unsigned long periyot = pollZamani[grup].periyot;
+  if (periyot < updateInterval) periyot = updateInterval;
+  return periyot * BAYAT_PERIYOT_KATSAYISI;
+}
+
+bool D300Controller::enqueueGroup(PollGrubu grup) {
+  switch (grup) {
+    case PollGrubu::Elektrik: return enqueueRead<D300Map::ElektrikRegisterlari>(static_cast<uint8_t>(grup));
+    case PollGrubu::Motor: return enqueueStep(&planlar[static_cast<uint8_t>(grup)], &D300Controller::processMotor);
+    case PollGrubu::Durum:
+      return enqueueRead<D300Map::DurumRegisterlari>(static_cast<uint8_t>(grup)) &&
+             enqueueStep(&D300Map::ALARM_PLANI, &D300Controller::processAlarms);
+    case PollGrubu::Sayac: return enqueueRead<D300Map::SayacRegisterlari>(static_cast<uint8_t>(grup));
+    case PollGrubu::Analog: return enqueueRead<D300Map::AnalogRegisterlari>(static_cast<uint8_t>(grup));
+    case PollGrubu::GPSIletisim: return enqueueRead<D300Map::GPSIletisimRegisterlari>(static_cast<uint8_t>(grup));
+    default: return false;
+  }
+}
+
+void D300Controller::onBlockComplete(void* baglam, ModbusSonuc sonuc) {
+  D300Controller* self = static_cast<D300Controller*>(baglam);
+  self->blokSonuc[self->aktifBlok] = sonuc;
+  self->blokGecerli[self->aktifBlok++] = (sonuc == ModbusSonuc::Basarili);
+  self->blokBekleniyor = false;
+  self->recordResult(sonuc);
+}
+
+void D300Controller::pumpReads() {
+  bus->poll();
+  completeSteps();
+  startNextBlock();
+}
+
+bool D300Controller::hasPendingBlock() const {
+  return !blokBekleniyor && kuyrukAdet > 0 && aktifBlok < okumaKuyrugu[kuyrukBas].plan->adet;
+}
+
+bool D300Controller::startNextBlock() {
+  // Bekleyen komut okuma bloğunun önüne geçer
+  if (startNextCommand()) return false;
+  if (!hasPendingBlock()) return false;
   
-  // Yük atma alarmları kontrolü
-  Sistem.YukAtmaAlarmi = false;
-  for (uint16_t addr = 10520; addr <= 10535; addr++) {
-    if (read16BitValue(addr, tempValue) && tempValue != 0) {
-      Sistem.YukAtmaAlarmi = true;
-      break;
+  // Sıradaki bloğu gönder; cevap sonraki çağrılarda toplanır
+  // Cevap doğrudan ham görüntüdeki yerine yazılır
+  const D300Map::BlokPlani* plan = okumaKuyrugu[kuyrukBas].plan;
+  const BlokOkuma &blok = plan->blok[aktifBlok];
+  int16_t ofset = D300Map::GORUNTU.ofsetBul(blok.baslangic, blok.adet);
+  if (ofset < 0) {
+    // Planlar görüntü parçalarından türediği için olmamalı; blok okunmadan geçilir
+    blokSonuc[aktifBlok] = ModbusSonuc::GecersizCevap;
+    blokGecerli[aktifBlok++] = false;
+    return false;
+  }
+  if (bus->startReadHoldingRegisters(slaveID, blok.baslangic, blok.adet,
+                                     &arka.Ham[ofset], onBlockComplete, this)) {
+    blokBekleniyor = true;
+    onay.araVer = false;
+  }
+  return blokBekleniyor;
+}
+
+void D300Controller::completeSteps() {
+  while (!blokBekleniyor && kuyrukAdet > 0) {
+    OkumaAdimi &adim = okumaKuyrugu[kuyrukBas];
+    if (aktifBlok < adim.plan->adet) return;
+    
+    // Tüm bloklar tamamlandı: geçerli bloklar veri yapılarına çözülür
+    sonAdimBasarili = false;
+    for (uint8_t i = 0; i < adim.plan->adet; i++) {
+      sonAdimBasarili |= blokGecerli[i];
+    }
+    okumaNesli++;
+    (this->*adim.isle)(*adim.plan, blokGecerli);
+    lastUpdateTime = millis();
+    
+    kuyrukBas = (kuyrukBas + 1) % MAX_OKUMA_ADIMI;
+    kuyrukAdet--;
+    aktifBlok = 0;
+    
+    // Tur tamamlandı: tüm gruplar aynı turdan yayınlanır
+    if (kuyrukAdet == 0) {
+      publishSnapshot();
     }
   }
+}
+
+// Komut kuyruğu
+bool D300Controller::queueCommand(uint16_t adres, uint16_t deger, KomutOnceligi oncelik,
+                                  KomutCallback callback, void* baglam) {
+  if (static_cast<uint8_t>(oncelik) >= KOMUT_ONCELIK_SAYISI) return false;
+  BusKilidi kilit(busKilidi);
+  uint32_t simdi = micros();
   
-  // Uyarı alarmları kontrolü
-  Sistem.UyariAlarmi = false;
-  for (uint16_t addr = 10536; addr <= 10551; addr++) {
-    if (read16BitValue(addr, tempValue) && tempValue != 0) {
-      Sistem.UyariAlarmi = true;
-      break;
+  int8_t bos = -1;
+  int8_t esi = -1;
+  for (uint8_t i = 0; i < MAX_KOMUT; i++) {
+    BekleyenKomut &k = komutlar[i];
+    if (!k.dolu) {
+      if (bos < 0) bos = i;
+      continue;
+    }
+    if (i == aktifKomut) continue;
+    
+    // Hatta çıkmamış aynı komut: art arda basımlar tek yazmaya iner. Farklı
+    // callback'ler kopya yuvada bekler ve asıl yazmanın sonucunu alır.
+    if (!k.iptal && k.s.adres == adres && k.s.deger == deger) {
+      if (callback == nullptr || (callback == k.callback && baglam == k.baglam)) return true;
+      if (k.esi < 0) {
+        if (k.callback == nullptr) {
+          k.callback = callback;
+          k.baglam = baglam;
+          return true;
+        }
+        esi = i;
+      }
+    }
+    
+    // Acil durdurmadan sonra sırada bekleyen buton basımları gönderilmez;
+    // iptal sonucu edinim bağlamında verilir
+    if (oncelik == KomutOnceligi::AcilDurdurma && k.s.oncelik == KomutOnceligi::Mod) {
+      k.iptal = true;
+    }
+  }
+  if (bos < 0) return false;
+  
+  BekleyenKomut &k = komutlar[bos];
+  k.s.adres = adres;
+  k.s.deger = deger;
+  k.s.oncelik = oncelik;
+  k.s.sonuc = ModbusSonuc::Mesgul;
+  k.s.kuyrukUs = simdi;
+  k.s.hatUs = 0;
+  k.s.bitisUs = 0;
+  k.callback = callback;
+  k.baglam = baglam;
+  k.sira = komutSirasi++;
+  k.esi = esi;
+  k.iptal = false;
+  k.dolu = true;
+  
+  // Görev varsa gönderim ve callback'ler ona kalır; uyandırılınca bir tik beklemez
+  if (edinimGorevi != nullptr) {
+    xTaskNotifyGive(edinimGorevi);
+    return true;
+  }
+  
+  // Görev yoksa hat boştaysa edinim turunu beklemeden gönderilir
+  finishCancellations();
+  bus->poll();
+  if (!bus->isBusy()) {
+    startNextCommand();
+  }
+  return true;
+}
+
+int8_t D300Controller::nextCommand() const {
+  if (aktifKomut >= 0) return -1;
+  int8_t secilen = -1;
+  for (uint8_t i = 0; i < MAX_KOMUT; i++) {
+    const BekleyenKomut &k = komutlar[i];
+    if (!k.dolu || k.esi >= 0 || k.iptal) continue;
+    if (secilen < 0 || k.s.oncelik < komutlar[secilen].s.oncelik ||
+        (k.s.oncelik == komutlar[secilen].s.oncelik && (int32_t)(k.sira - komutlar[secilen].sira) < 0)) {
+      secilen = i;
+    }
+  }
+  return secilen;
+}
+
+int8_t D300Controller::pendingCommandPriority() const {
+  // Onay okuması komutlardan sonra, okuma bloklarından önce gelir
+  int8_t i = nextCommand();
+  if (i >= 0) return static_cast<int8_t>(komutlar[i].s.oncelik);
+  return confirmationDue() ? KOMUT_ONCELIK_SAYISI : -1;
+}
+
+bool D300Controller::startNextCommand() {
+  int8_t i = nextCommand();
+  if (i < 0) return confirmationDue() && startConfirmationRead();
+  BekleyenKomut &k = komutlar[i];
+  if (!bus->startWriteSingleRegister(slaveID, k.s.adres, k.s.deger, onCommandComplete, this)) {
+    return false;
+  }
+  aktifKomut = i;
+  return true;
+}
+
+void D300Controller::onCommandComplete(void* baglam, ModbusSonuc sonuc) {
+  D300Controller* self = static_cast<D300Controller*>(baglam);
+  uint32_t simdi = micros();
+  self->recordResult(sonuc);
+  if (self->aktifKomut < 0) return;
+  
+  BekleyenKomut &k = self->komutlar[self->aktifKomut];
+  self->aktifKomut = -1;
+  k.s.hatUs = self->bus->getGonderimUs();
+  
+  // Gecikme: kuyruğa alınmadan isteğin hatta çıkmasına kadar
+  KomutGecikmesi &g = self->komutGecikmesi[static_cast<uint8_t>(k.s.oncelik)];
+  uint32_t gecikme = k.s.hatUs - k.s.kuyrukUs;
+  g.adet++;
+  g.sonUs = gecikme;
+  g.toplamUs += gecikme;
+  if (gecikme > g.maxUs) g.maxUs = gecikme;
+  
+  self->finishCommand(k, sonuc, simdi);
+}
+
+void D300Controller::finishCommand(BekleyenKomut& komut, ModbusSonuc sonuc, uint32_t zaman) {
+  // Aynı yazmayı bekleyen kopyalar aynı sonucu alır. Yuvalar callback'lerden
+  // önce boşaltılır; callback yeni komut ekleyebilir.
+  int8_t asil = static_cast<int8_t>(&komut - komutlar);
+  KomutSonucu s = komut.s;
+  s.sonuc = sonuc;
+  s.bitisUs = zaman;
+  
+  KomutCallback callbackler[MAX_KOMUT];
+  void* baglamlar[MAX_KOMUT];
+  uint8_t adet = 0;
+  for (uint8_t i = 0; i < MAX_KOMUT; i++) {
+    BekleyenKomut &k = komutlar[i];
+    if (!k.dolu || (i != asil && k.esi != asil)) continue;
+    k.dolu = false;
+    if (k.callback) {
+      callbackler[adet] = k.callback;
+      baglamlar[adet++] = k.baglam;
+    }
+  }
+  for (uint8_t i = 0; i < adet; i++) {
+    callbackler[i](baglamlar[i], s);
+  }
+}
+
+void D300Controller::finishCancellations() {
+  uint32_t simdi = micros();
+  for (uint8_t i = 0; i < MAX_KOMUT; i++) {
+    if (komutlar[i].dolu && komutlar[i].iptal) {
+      finishCommand(komutlar[i], ModbusSonuc::Iptal, simdi);
+    }
+  }
+  
+  // Callback yeni onaylı komut ekleyip listeye yazabilir; sırayla tüketilir
+  while (iptalOnayAdet > 0) {
+    IptalOnay iptal = iptalOnaylari[0];
+    iptalOnayAdet--;
+    memmove(&iptalOnaylari[0], &iptalOnaylari[1], iptalOnayAdet * sizeof(IptalOnay));
+    if (iptal.callback) iptal.callback(iptal.baglam, iptal.rapor);
+  }
+}
+
+// Komut onayı
+bool D300Controller::queueConfirmedCommand(uint16_t adres, uint16_t deger, KomutOnceligi oncelik,
+                                           uint16_t beklenenMod, OnayCallback callback, void* baglam,
+                                           unsigned long pencereMs) {
+  BusKilidi kilit(busKilidi);
+  if (onay.aktif) {
+    // Yerine gelen komut öncekini iptal eder; rapor edinim bağlamında verilir
+    if (iptalOnayAdet >= MAX_IPTAL_ONAY) return false;
+    IptalOnay &iptal = iptalOnaylari[iptalOnayAdet++];
+    iptal.callback = onay.callback;
+    iptal.baglam = onay.baglam;
+    iptal.rapor = closeConfirmation(OnaySonucu::Iptal, millis());
+  }
+  
+  // Önceki değerler son okunan görüntüden
+  int16_t ofset = D300Map::GORUNTU.ofsetBul(D300Map::ONAY_ADRESI, 2);
+  memset(&onay, 0, sizeof(onay));
+  onay.aktif = true;
+  onay.beklenenMod = beklenenMod;
+  onay.pencereMs = pencereMs;
+  onay.callback = callback;
+  onay.baglam = baglam;
+  onay.rapor.komut.adres = adres;
+  onay.rapor.komut.deger = deger;
+  onay.rapor.oncekiDurum = static_cast<UniteDurumu>(arka.Ham[ofset]);
+  onay.rapor.oncekiMod = static_cast<UniteModu>(arka.Ham[ofset + 1]);
+  
+  if (!queueCommand(adres, deger, oncelik, onConfirmedCommand, this)) {
+    onay.aktif = false;
+    return false;
+  }
+  return true;
+}
+
+void D300Controller::onConfirmedCommand(void* baglam, const KomutSonucu& sonuc) {
+  D300Controller* self = static_cast<D300Controller*>(baglam);
+  AktifOnay &onay = self->onay;
+  
+  // Yerine yenisi gelmiş bir onaylı komutun sonucu yok sayılır
+  if (!onay.aktif || onay.yazildi ||
+      sonuc.adres != onay.rapor.komut.adres || sonuc.deger != onay.rapor.komut.deger) {
+    return;
+  }
+  onay.rapor.komut = sonuc;
+  if (sonuc.sonuc == ModbusSonuc::Iptal) {
+    self->finishConfirmation(OnaySonucu::Iptal, millis());
+  } else if (sonuc.sonuc != ModbusSonuc::Basarili) {
+    self->finishConfirmation(OnaySonucu::YazmaHatasi, millis());
+  } else {
+    // Okumalar bir sonraki boş çerçevede başlar
+    onay.yazildi = true;
+    onay.baslangic = millis();
+    onay.rapor.yazmaZamani = onay.baslangic;
+  }
+}
+
+bool D300Controller::confirmationDue() const {
+  return onay.aktif && onay.yazildi && !onay.okumaBekleniyor && !(onay.araVer && hasPendingBlock());
+}
+
+bool D300Controller::startConfirmationRead() {
+  // Cevap ham görüntüdeki yerine yazılır; grup okunduğunda D300Veri'ye çözülür
+  int16_t ofset = D300Map::GORUNTU.ofsetBul(D300Map::ONAY_ADRESI, 2);
+  if (!bus->startReadHoldingRegisters(slaveID, D300Map::ONAY_ADRESI, 2, &arka.Ham[ofset],
+                                      onConfirmationRead, this)) {
+    return false;
+  }
+  onay.okumaBekleniyor = true;
+  return true;
+}
+
+void D300Controller::onConfirmationRead(void* baglam, ModbusSonuc sonuc) {
+  D300Controller* self = static_cast<D300Controller*>(baglam);
+  AktifOnay &onay = self->onay;
+  self->recordResult(sonuc);
+  onay.okumaBekleniyor = false;
+  onay.araVer = true;
+  if (!onay.aktif) return;
+  onay.rapor.okumaSayisi++;
+  
+  unsigned long simdi = millis();
+  if (sonuc == ModbusSonuc::Basarili) {
+    int16_t ofset = D300Map::GORUNTU.ofsetBul(D300Map::ONAY_ADRESI, 2);
+    uint16_t durum = self->arka.Ham[ofset];
+    uint16_t mod = self->arka.Ham[ofset + 1];
+    bool gecti = onay.beklenenMod
+                   ? mod == onay.beklenenMod
+                   : durum != static_cast<uint16_t>(onay.rapor.oncekiDurum) ||
+                     mod != static_cast<uint16_t>(onay.rapor.oncekiMod);
+    if (gecti) {
+      self->finishConfirmation(OnaySonucu::Onaylandi, simdi);
+      return;
+    }
+  }
+  self->checkConfirmation(simdi);
+}
+
+void D300Controller::checkConfirmation(unsigned long zaman) {
+  if (onay.aktif && onay.yazildi && zaman - onay.baslangic >= onay.pencereMs) {
+    finishConfirmation(OnaySonucu::ZamanAsimi, zaman);
+  }
+}
+
+KomutOnayi D300Controller::closeConfirmation(OnaySonucu sonuc, unsigned long zaman) {
+  int16_t ofset = D300Map::GORUNTU.ofsetBul(D300Map::ONAY_ADRESI, 2);
+  KomutOnayi rapor = onay.rapor;
+  onay.aktif = false;
+  
+  rapor.sonuc = sonuc;
+  rapor.yeniDurum = static_cast<UniteDurumu>(arka.Ham[ofset]);
+  rapor.yeniMod = static_cast<UniteModu>(arka.Ham[ofset + 1]);
+  rapor.onayZamani = zaman;
+  return rapor;
+}
+
+void D300Controller::finishConfirmation(OnaySonucu sonuc, unsigned long zaman) {
+  OnayCallback callback = onay.callback;
+  void* baglam = onay.baglam;
+  KomutOnayi rapor = closeConfirmation(sonuc, zaman);
+  if (callback) callback(baglam, rapor);
+}
+
+uint8_t D300Controller::getBekleyenKomutSayisi() const {
+  uint8_t adet = 0;
+  for (uint8_t i = 0; i < MAX_KOMUT; i++) {
+    if (komutlar[i].dolu) adet++;
+  }
+  return adet;
+}
+
+void D300Controller::resetKomutGecikmesi() {
+  BusKilidi kilit(busKilidi);
+  for (uint8_t i = 0; i < KOMUT_ONCELIK_SAYISI; i++) {
+    komutGecikmesi[i] = KomutGecikmesi();
+  }
+}
+
+bool D300Controller::drainReads() {
+  while (kuyrukAdet > 0) {
+    pumpReads();
+    bus->waitForCompletion();
+  }
+  return sonAdimBasarili;
+}
+
+// Register desteği
+static const char* DESTEK_NVS_ALANI = "d300_destek";
+
+// Harita değişince eski NVS kayıtları geçersiz olsun diye adreslerden imza
+static constexpr uint16_t haritaImzasi() {
+  uint16_t imza = D300Map::TumRegisterlar::alanSayisi;
+  for (uint8_t i = 0; i < D300Map::TumRegisterlar::alanSayisi; i++) {
+    imza = (uint16_t)(imza * 31 + D300Map::TumRegisterlar::sirali.a[i].adres);
+  }
+  return imza;
+}
+
+static int16_t registerIndeksi(uint16_t adres) {
+  // Sıralı haritada ikili arama
+  int16_t alt = 0;
+  int16_t ust = D300Map::TumRegisterlar::alanSayisi - 1;
+  while (alt <= ust) {
+    int16_t orta = (alt + ust) / 2;
+    uint16_t a = D300Map::TumRegisterlar::sirali.a[orta].adres;
+    if (a == adres) return orta;
+    if (a < adres) alt = orta + 1;
+    else ust = orta - 1;
+  }
+  return -1;
+}
+
+static bool okunur(RegisterDestegi d) {
+  return d != RegisterDestegi::Istisna && d != RegisterDestegi::ZamanAsimi;
+}
+
+bool D300Controller::isRegisterSupported(uint16_t adres) const {
+  return okunur(getRegisterDestegi(adres));
+}
+
+// [bas, son) boşluğu bir bloğun içinde okunabilir mi: içindeki harita alanları
+// desteklenmeli, alanlar arası boşluklar da okunamadığı görülmemiş olmalı
+bool D300Controller::isGapReadable(uint16_t bas, uint16_t son) const {
+  const RegisterAraligi* a = D300Map::TumRegisterlar::sirali.a;
+  const uint8_t alanSayisi = D300Map::TumRegisterlar::alanSayisi;
+  for (uint8_t i = 0; i < alanSayisi; i++) {
+    uint16_t alanSonu = a[i].adres + a[i].genislik;
+    if (a[i].adres >= son) break;
+    if (alanSonu > bas && !okunur(registerDestegi[i])) return false;
+    if (i + 1 < alanSayisi && alanSonu < a[i + 1].adres &&
+        alanSonu < son && a[i + 1].adres > bas && !okunur(boslukDestegi[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+RegisterDestegi D300Controller::getRegisterDestegi(uint16_t adres) const {
+  int16_t i = registerIndeksi(adres);
+  return i < 0 ? RegisterDestegi::Bilinmiyor : registerDestegi[i];
+}
+
+AlanKalitesi D300Controller::getAlanKalitesi(uint16_t adres) const {
+  int16_t i = registerIndeksi(adres);
+  if (i < 0) return AlanKalitesi::Yok;
+  AlanKalitesi kalite = Meta.Kalite[i];
+  if (kalite == AlanKalitesi::Iyi && millis() - Meta.Zaman[i] > staleLimit(i)) {
+    return AlanKalitesi::Bayat;
+  }
+  return kalite;
+}
+
+unsigned long D300Controller::getAlanYasi(uint16_t adres) const {
+  int16_t i = registerIndeksi(adres);
+  if (i < 0 || Meta.Zaman[i] == 0) return ULONG_MAX;
+  return millis() - Meta.Zaman[i];
+}
+
+bool D300Controller::isAlarmVerisiTaze() const {
+  return Meta.Kalite[ALARM_META_INDEKSI] == AlanKalitesi::Iyi &&
+         millis() - Meta.Zaman[ALARM_META_INDEKSI] <= staleLimit(ALARM_META_INDEKSI);
+}
+
+const char* D300Controller::getKaliteAciklama(AlanKalitesi kalite) {
+  switch (kalite) {
+    case AlanKalitesi::Iyi: return "good";
+    case AlanKalitesi::Bayat: return "stale";
+    case AlanKalitesi::Istisna: return "exception";
+    case AlanKalitesi::ZamanAsimi: return "timeout";
+    case AlanKalitesi::Hata: return "error";
+    default: return "none";
+  }
+}
+
+uint8_t D300Controller::getDesteklenmeyenSayisi() const {
+  uint8_t adet = 0;
+  for (uint8_t i = 0; i < D300Map::TumRegisterlar::alanSayisi; i++) {
+    if (!isRegisterSupported(D300Map::TumRegisterlar::sirali.a[i].adres)) adet++;
+  }
+  return adet;
+}
+
+void D300Controller::rebuildPlans() {
+  auto destekli = [this](uint16_t adres) { return isRegisterSupported(adres); };
+  auto boslukOkunur = [this](uint16_t bas, uint16_t son) { return isGapReadable(bas, son); };
+  
+  planlar[static_cast<uint8_t>(PollGrubu::Elektrik)] = D300Map::ElektrikRegisterlari::planlaFiltreli(destekli, boslukOkunur);
+  planlar[static_cast<uint8_t>(PollGrubu::Motor)] = D300Map::MotorRegisterlari::planlaFiltreli(destekli, boslukOkunur);
+  planlar[static_cast<uint8_t>(PollGrubu::Durum)] = D300Map::DurumRegisterlari::planlaFiltreli(destekli, boslukOkunur);
+  planlar[static_cast<uint8_t>(PollGrubu::Sayac)] = D300Map::SayacRegisterlari::planlaFiltreli(destekli, boslukOkunur);
+  planlar[static_cast<uint8_t>(PollGrubu::Analog)] = D300Map::AnalogRegisterlari::planlaFiltreli(destekli, boslukOkunur);
+  planlar[static_cast<uint8_t>(PollGrubu::GPSIletisim)] = D300Map::GPSIletisimRegisterlari::planlaFiltreli(destekli, boslukOkunur);
+  planlar[PLAN_TEMEL] = D300Map::TemelRegisterlar::planlaFiltreli(destekli, boslukOkunur);
+  planlar[PLAN_EK] = D300Map::EkRegisterlar::planlaFiltreli(destekli, boslukOkunur);
+}
+
+void D300Controller::probeRange(uint8_t bas, uint8_t son) {
+  // Aralığı tek istekte dene; olmazsa ikiye bölerek sorunlu register'ı bul
+  const RegisterAraligi* a = D300Map::TumRegisterlar::sirali.a;
+  uint16_t adres = a[bas].adres;
+  uint16_t adet = a[son - 1].adres + a[son - 1].genislik - adres;
+  
+  if (adet <= D300ModbusRtu::MAX_REGISTER) {
+    ModbusSonuc sonuc = bus->readHoldingRegisters(slaveID, adres, adet, blokTampon);
+    if (sonuc == ModbusSonuc::Basarili) {
+      for (uint8_t i = bas; i < son; i++) registerDestegi[i] = RegisterDestegi::Destekleniyor;
+      for (uint8_t i = bas; i + 1 < son; i++) boslukDestegi[i] = RegisterDestegi::Destekleniyor;
+      return;
+    }
+    if (son - bas == 1) {
+      if (D300ModbusRtu::isIstisna(sonuc)) registerDestegi[bas] = RegisterDestegi::Istisna;
+      else if (sonuc == ModbusSonuc::ZamanAsimi) registerDestegi[bas] = RegisterDestegi::ZamanAsimi;
+      else registerDestegi[bas] = RegisterDestegi::Bilinmiyor;   // CRC vb. - okunmaya devam
+      return;
+    }
+  }
+  
+  uint8_t orta = (bas + son) / 2;
+  probeRange(bas, orta);
+  probeRange(orta, son);
+}
+
+// Bölünerek yoklanan aralıklarda komşu alanlar arasındaki boşluk hiç okunmamış
+// olabilir; planların birleştirebileceği her boşluk, iki komşusuyla birlikte
+// tam okunacağı haliyle ayrıca denenir
+void D300Controller::probeGaps() {
+  const RegisterAraligi* a = D300Map::TumRegisterlar::sirali.a;
+  for (uint8_t i = 0; i + 1 < D300Map::TumRegisterlar::alanSayisi; i++) {
+    uint16_t alanSonu = a[i].adres + a[i].genislik;
+    if (alanSonu >= a[i + 1].adres) {
+      boslukDestegi[i] = RegisterDestegi::Destekleniyor;   // Boşluk yok
+      continue;
+    }
+    if (a[i + 1].adres - alanSonu > D300Map::MAX_BLOK_BOSLUK ||
+        boslukDestegi[i] == RegisterDestegi::Destekleniyor ||
+        !okunur(registerDestegi[i]) || !okunur(registerDestegi[i + 1])) {
+      continue;   // Planlar bu boşluğu zaten birleştirmez
+    }
+    
+    uint16_t adet = a[i + 1].adres + a[i + 1].genislik - a[i].adres;
+    ModbusSonuc sonuc = bus->readHoldingRegisters(slaveID, a[i].adres, adet, blokTampon);
+    if (sonuc == ModbusSonuc::Basarili) boslukDestegi[i] = RegisterDestegi::Destekleniyor;
+    else if (D300ModbusRtu::isIstisna(sonuc)) boslukDestegi[i] = RegisterDestegi::Istisna;
+    else if (sonuc == ModbusSonuc::ZamanAsimi) boslukDestegi[i] = RegisterDestegi::ZamanAsimi;
+    else boslukDestegi[i] = RegisterDestegi::Bilinmiyor;
+  }
+}
+
+bool D300Controller::probeRegisterSupport(bool zorla) {
+  BusKilidi kilit(busKilidi);
+  const uint8_t alanSayisi = D300Map::TumRegisterlar::alanSayisi;
+  
+  // Planlar değişmeden önce kuyruktaki okumalar tamamlanır
+  drainReads();
+  
+  // Önbellek anahtarı: CihazKimlik (10609) ve YazilimVersiyon (10611)
+  uint16_t kimlik[3];
+  if (!readMultipleRegisters(10609, 3, kimlik)) {
+    return false;
+  }
+  char anahtar[16];
+  snprintf(anahtar, sizeof(anahtar), "%04x_%04x", kimlik[0], kimlik[2]);
+  
+  struct {
+    uint16_t imza;
+    RegisterDestegi destek[alanSayisi];
+    RegisterDestegi bosluk[alanSayisi];
+  } kayit;
+  
+  Preferences nvs;
+  nvs.begin(DESTEK_NVS_ALANI, false);
+  
+  bool yuklendi = !zorla &&
+                  nvs.getBytes(anahtar, &kayit, sizeof(kayit)) == sizeof(kayit) &&
+                  kayit.imza == haritaImzasi();
+  if (!yuklendi) {
+    for (uint8_t i = 0; i < alanSayisi; i++) boslukDestegi[i] = RegisterDestegi::Bilinmiyor;
+    probeRange(0, alanSayisi);
+    probeGaps();
+    kayit.imza = haritaImzasi();
+    memcpy(kayit.destek, registerDestegi, sizeof(kayit.destek));
+    memcpy(kayit.bosluk, boslukDestegi, sizeof(kayit.bosluk));
+    nvs.putBytes(anahtar, &kayit, sizeof(kayit));
+  }
+  nvs.end();
+  
+  memcpy(registerDestegi, kayit.destek, sizeof(kayit.destek));
+  memcpy(boslukDestegi, kayit.bosluk, sizeof(kayit.bosluk));
+  rebuildPlans();
+  return true;
+}
+
+void D300Controller::processMotor(const D300Map::BlokPlani& plan, const bool* blokGecerli) {
+  commitGroup<D300Map::MotorRegisterlari>(plan, blokGecerli);
+  
+  // Harici yakıt sensörü: arka planda süzülen son seviye
+  arka.HariciYakitSeviyesi = getHariciYakitSeviyesi();
+}
+
+void D300Controller::processAlarms(const D300Map::BlokPlani& plan, const bool* blokGecerli) {
+  // 48 alarm register'ı tek istekte okunur
+  markField(ALARM_META_INDEKSI, blokSonuc[0], millis());
+  if (!blokGecerli[0]) {
+    return;  // Okunamazsa önceki durum korunur, sahte "kalktı" olayı üretilmez
+  }
+  const uint16_t* yeniBitler = &arka.Ham[D300Map::GORUNTU.ofsetBul(ALARM_BASLANGIC_ADRESI, ALARM_KELIME_SAYISI)];
+  
+  unsigned long simdi = millis();
+  
+  for (uint8_t kelime = 0; kelime < ALARM_KELIME_SAYISI; kelime++) {
+    uint16_t degisen = yeniBitler[kelime] ^ alarmBitleri[kelime];
+    
+    // Değişen her bit için olay üret
+    while (degisen && alarmCallback) {
+      uint8_t bitNo = __builtin_ctz(degisen);
+      degisen &= degisen - 1;
+      
+      AlarmOlayi olay;
+      olay.bit = kelime * 16 + bitNo;
+      olay.tip = getAlarmTipi(olay.bit);
+      olay.aktif = (yeniBitler[kelime] >> bitNo) & 1;
+      olay.zaman = simdi;
+      alarmCallback(olay);
+    }
+    alarmBitleri[kelime] = yeniBitler[kelime];
+  }
+}
+
+void D300Controller::publishSnapshot() {
+  // Seqlock: tek sıra numarası yazım sürüyor demektir
+  uint32_t sira = yayinSira.load(std::memory_order_relaxed);
+  yayinSira.store(sira + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  yayin = arka;
+  yayinSira.store(sira + 2, std::memory_order_release);
+}
+
+uint32_t D300Controller::copyPublished(HamVeri& hedef) const {
+  for (;;) {
+    uint32_t sira = yayinSira.load(std::memory_order_acquire);
+    if (sira & 1) {
+      continue;   // Yazım sürüyor, kopya birkaç mikrosaniye sürer
+    }
+    hedef = yayin;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (yayinSira.load(std::memory_order_relaxed) == sira) {
+      return sira;
+    }
+  }
+}
+
+uint32_t D300Controller::getSnapshot(D300Veri& hedef) const {
+  // Yayın doğrudan hedefe çözülür; okuyucunun (WebSocket/WebServer işleyicileri)
+  // yığınına ~2 KB'lık HamVeri kopyası alınmaz. Çözüm sürerken yeni tur
+  // yayınlandıysa yarım kalan sonuç atılıp tekrar çözülür.
+  for (;;) {
+    uint32_t sira = yayinSira.load(std::memory_order_acquire);
+    if (sira & 1) {
+      continue;   // Yazım sürüyor
+    }
+    decodeImage(hedef, yayin, nullptr);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (yayinSira.load(std::memory_order_relaxed) == sira) {
+      return sira;
+    }
+  }
+}
+
+void D300Controller::refreshSnapshot() {
+  if (yayinSira.load(std::memory_order_acquire) == yerelSira) return;
+  yerelSira = copyPublished(yerel);
+  
+  uint8_t grupMaskesi = 0;
+  for (uint8_t g = 0; g < POLL_GRUP_SAYISI; g++) {
+    if (yerel.GrupNesli[g] != cozulenNesil[g]) grupMaskesi |= 1 << g;
+  }
+  decodeImage(*this, yerel, cozulenNesil);
+  if (grupMaskesi) detectChanges(grupMaskesi);
+}
+
+void D300Controller::detectChanges(uint8_t grupMaskesi) {
+  using namespace D300Map;
+  
+  for (uint8_t i = 0; i < TumRegisterlar::alanSayisi; i++) {
+    if (!(grupMaskesi & (1 << alanGrubu[i])) || Meta.Kalite[i] == AlanKalitesi::Yok) continue;
+    
+    const AlanTanimi &tanim = TumRegisterlar::tanimlar.a[i];
+    const uint16_t* reg = &yerel.Ham[ALAN_OFSETLERI.a[i]];
+    uint32_t yeni = (tanim.genislik == 2) ? (((uint32_t)reg[0] << 16) | reg[1]) : reg[0];
+    uint32_t eski = bildirilenHam[i];
+    if (yeni == eski && alanDegisimNesli[i] != 0) continue;
+    
+    // İlk geçerli değer her zaman bildirilir; float alanlarda ölü bant yok
+    if (alanDegisimNesli[i] != 0 && !tanim.kayan) {
+      int64_t y = tanim.isaretli ? (tanim.genislik == 2 ? (int64_t)(int32_t)yeni : (int64_t)(int16_t)yeni) : (int64_t)yeni;
+      int64_t e = tanim.isaretli ? (tanim.genislik == 2 ? (int64_t)(int32_t)eski : (int64_t)(int16_t)eski) : (int64_t)eski;
+      int64_t fark = y > e ? y - e : e - y;
+      int64_t buyukluk = e < 0 ? -e : e;
+      if (fark <= (int64_t)oluBantMutlak[i] || fark * 1000 <= buyukluk * oluBantBinde[i]) continue;
+    }
+    
+    bildirilenHam[i] = yeni;
+    alanDegisimNesli[i] = ++degisimNesli;
+    kirliBitler[i / 32] |= 1UL << (i % 32);
+  }
+  
+  // Alarm bitleri her değişimde bildirilir
+  if ((grupMaskesi & (1 << static_cast<uint8_t>(PollGrubu::Durum))) &&
+      memcmp(bildirilenAlarmlar, Sistem.AlarmBitleri, sizeof(bildirilenAlarmlar)) != 0) {
+    memcpy(bildirilenAlarmlar, Sistem.AlarmBitleri, sizeof(bildirilenAlarmlar));
+    alanDegisimNesli[ALARM_META_INDEKSI] = ++degisimNesli;
+    kirliBitler[ALARM_META_INDEKSI / 32] |= 1UL << (ALARM_META_INDEKSI % 32);
+  }
+}
+
+void D300Controller::setDeadband(uint16_t adres, float mutlak, float bagilYuzde) {
+  int16_t i = registerIndeksi(adres);
+  if (i < 0) return;
+  
+  // Mühendislik birimi ham birime çevrilir (230.1 V, katsayı 10 -> 2301)
+  oluBantMutlak[i] = (uint32_t)(mutlak * D300Map::TumRegisterlar::tanimlar.a[i].katsayi + 0.5f);
+  oluBantBinde[i] = (uint16_t)(bagilYuzde * 10.0f + 0.5f);
+}
+
+bool D300Controller::isAlanDegisti(uint16_t adres, uint32_t nesil) const {
+  int16_t i = registerIndeksi(adres);
+  return i >= 0 && alanDegisimNesli[i] > nesil;
+}
+
+uint8_t D300Controller::getDegisenAlanlar(uint32_t nesil, uint32_t* bitler) const {
+  uint8_t adet = 0;
+  memset(bitler, 0, KIRLI_KELIME_SAYISI * sizeof(uint32_t));
+  for (uint8_t i = 0; i <= ALARM_META_INDEKSI; i++) {
+    if (alanDegisimNesli[i] > nesil) {
+      bitler[i / 32] |= 1UL << (i % 32);
+      adet++;
+    }
+  }
+  return adet;
+}
+
+void D300Controller::decodeImage(D300Veri& hedef, const HamVeri& kaynak, uint32_t* cozulenNesil) const {
+  using namespace D300Map;
+  
+  // Sadece son çözümden beri yeniden okunan gruplar çözülür (cozulenNesil null ise hepsi)
+  for (uint8_t g = 0; g < POLL_GRUP_SAYISI; g++) {
+    if (cozulenNesil) {
+      if (cozulenNesil[g] == kaynak.GrupNesli[g]) continue;
+      cozulenNesil[g] = kaynak.GrupNesli[g];
+    }
+    
+    const uint16_t* ham = kaynak.Ham;
+    switch (static_cast<PollGrubu>(g)) {
+      case PollGrubu::Elektrik:
+        ElektrikRegisterlari::cozGoruntu<GORUNTU>(hedef, ham);
+        deriveMetrics(hedef.ElektrikSistemi.Sebeke, nominalGucKw[0]);
+        deriveMetrics(hedef.ElektrikSistemi.Jenerator, nominalGucKw[1]);
+        break;
+      case PollGrubu::Motor: MotorRegisterlari::cozGoruntu<GORUNTU>(hedef, ham); break;
+      case PollGrubu::Durum: {
+        DurumRegisterlari::cozGoruntu<GORUNTU>(hedef, ham);
+        
+        const uint16_t* bitler = &ham[GORUNTU.ofsetBul(ALARM_BASLANGIC_ADRESI, ALARM_KELIME_SAYISI)];
+        uint16_t aktifTipler[3] = {0, 0, 0};
+        for (uint8_t kelime = 0; kelime < ALARM_KELIME_SAYISI; kelime++) {
+          aktifTipler[kelime / ALARM_TIP_KELIME_SAYISI] |= bitler[kelime];
+        }
+        memcpy(hedef.Sistem.AlarmBitleri, bitler, sizeof(hedef.Sistem.AlarmBitleri));
+        hedef.Sistem.KapatmaAlarmi = aktifTipler[0] != 0;
+        hedef.Sistem.YukAtmaAlarmi = aktifTipler[1] != 0;
+        hedef.Sistem.UyariAlarmi = aktifTipler[2] != 0;
+        break;
+      }
+      case PollGrubu::Sayac: SayacRegisterlari::cozGoruntu<GORUNTU>(hedef, ham); break;
+      case PollGrubu::Analog: AnalogRegisterlari::cozGoruntu<GORUNTU>(hedef, ham); break;
+      case PollGrubu::GPSIletisim: GPSIletisimRegisterlari::cozGoruntu<GORUNTU>(hedef, ham); break;
+      default: break;
+    }
+  }
+  
+  hedef.Meta = kaynak.Meta;
+  hedef.Motor.HariciYakitSeviyesi = kaynak.HariciYakitSeviyesi;
+}
+
+// Üç değerin ortalamasından en büyük sapması, ortalamanın yüzdesi olarak
+static float dengesizlik(float a, float b, float c) {
+  float ort = (a + b + c) / 3.0f;
+  if (ort <= 0.0f) return 0.0f;
+  float sapma = fabsf(a - ort);
+  if (fabsf(b - ort) > sapma) sapma = fabsf(b - ort);
+  if (fabsf(c - ort) > sapma) sapma = fabsf(c - ort);
+  return sapma / ort * 100.0f;
+}
+
+// Cihaz görünür gücü ya da güç faktörünü vermiyorsa (0) aktif ve reaktiften tamamlanır
+static void tamamlaGuc(float aktif, float reaktif, float& gorunur, float& gucFaktoru) {
+  if (gorunur == 0.0f && (aktif != 0.0f || reaktif != 0.0f)) {
+    gorunur = sqrtf(aktif * aktif + reaktif * reaktif);
+  }
+  if (gucFaktoru == 0.0f && gorunur > 0.0f) {
+    gucFaktoru = aktif / gorunur;
+  }
+}
+
+void D300Controller::deriveMetrics(ElektrikselSistem& sistem, float nominalGuc) {
+  static const float KOK3 = 1.7320508f;
+  FazVerisi* fazlar[3] = {&sistem.L1, &sistem.L2, &sistem.L3};
+  for (FazVerisi* faz : fazlar) {
+    tamamlaGuc(faz->AktifGuc, faz->ReaktifGuc, faz->GorunurGuc, faz->GucFaktoru);
+  }
+  tamamlaGuc(sistem.Toplam.AktifGuc, sistem.Toplam.ReaktifGuc, sistem.Toplam.GorunurGuc, sistem.Toplam.GucFaktoru);
+  
+  sistem.VoltajDengesizligi = dengesizlik(sistem.L1.Voltaj, sistem.L2.Voltaj, sistem.L3.Voltaj);
+  sistem.AkimDengesizligi = dengesizlik(sistem.L1.Akim, sistem.L2.Akim, sistem.L3.Akim);
+  
+  // Dengeli sistemde faz-faz = √3 x faz-nötr; büyük sapma bağlantı ya da ölçüm hatasıdır
+  const float fazFaz[3] = {sistem.FazVoltajL1L2, sistem.FazVoltajL2L3, sistem.FazVoltajL3L1};
+  float enBuyuk = 0.0f;
+  for (uint8_t i = 0; i < 3; i++) {
+    float beklenen = KOK3 * (fazlar[i]->Voltaj + fazlar[(i + 1) % 3]->Voltaj) / 2.0f;
+    if (beklenen <= 0.0f || fazFaz[i] <= 0.0f) continue;
+    float sapma = fabsf(fazFaz[i] - beklenen) / beklenen * 100.0f;
+    if (sapma > enBuyuk) enBuyuk = sapma;
+  }
+  sistem.FazFazSapmasi = enBuyuk;
+  
+  sistem.YukYuzdesi = nominalGuc > 0.0f ? sistem.Toplam.AktifGuc / nominalGuc * 100.0f : 0.0f;
+}
+
+void D300Controller::setNominalGuc(float jeneratorKw, float sebekeKw) {
+  nominalGucKw[0] = sebekeKw;
+  nominalGucKw[1] = jeneratorKw;
+  
+  // Sonraki yenilemede elektrik grubu yeni payda ile yeniden çözülür
+  cozulenNesil[static_cast<uint8_t>(PollGrubu::Elektrik)] = 0;
+}
+
+String D300Controller::getChangesAsJSON(uint32_t nesil) const {
+  return jsonMetni([&](JsonYazici& j) { writeChangesJson(j, nesil); });
+}
+
+void D300Controller::writeChangesJson(JsonYazici& j, uint32_t nesil) const {
+  // Değerler son bildirilen (ölü bandı aşan) ham değerlerden yazılır
+  j.nesneBasla().alan("gen", degisimNesli).nesneBasla("changes");
+  
+  for (uint8_t i = 0; i < D300Map::TumRegisterlar::alanSayisi; i++) {
+    if (alanDegisimNesli[i] <= nesil) continue;
+    
+    const D300Map::AlanTanimi &tanim = D300Map::TumRegisterlar::tanimlar.a[i];
+    uint32_t ham = bildirilenHam[i];
+    j.anahtar(tanim.adres);
+    if (tanim.kayan) {
+      float f;
+      memcpy(&f, &ham, sizeof(f));
+      j.deger(f, 6);
+    } else {
+      int64_t v = tanim.isaretli ? (tanim.genislik == 2 ? (int64_t)(int32_t)ham : (int64_t)(int16_t)ham) : (int64_t)ham;
+      j.sabit(v, D300Sabit::basamak(tanim.katsayi));
+    }
+  }
+  j.nesneBitir();
+  
+  if (alanDegisimNesli[ALARM_META_INDEKSI] > nesil) {
+    j.diziBasla("alarms");
+    for (uint8_t kelime = 0; kelime < ALARM_KELIME_SAYISI; kelime++) {
+      uint16_t bitler = bildirilenAlarmlar[kelime];
+      while (bitler) {
+        uint8_t bitNo = __builtin_ctz(bitler);
+        bitler &= bitler - 1;
+        j.deger(kelime * 16 + bitNo);
+      }
     }
+    j.diziBitir();
   }
+  j.nesneBitir();
+}
+
+uint8_t D300Controller::getAlanSayisi() {
+  return D300Map::TumRegisterlar::alanSayisi;
+}
+
+uint16_t D300Controller::getAlanAdresi(uint8_t i) {
+  return i < D300Map::TumRegisterlar::alanSayisi ? D300Map::TumRegisterlar::sirali.a[i].adres : 0;
+}
+
+uint16_t D300Controller::getHamGoruntuBoyutu() {
+  return D300Map::GORUNTU.boyut;
+}
+
+int16_t D300Controller::getHamOfset(uint16_t adres, uint8_t genislik) {
+  return D300Map::GORUNTU.ofsetBul(adres, genislik);
 }
 
 bool D300Controller::updateBasicData() {
-  updateElektrikselVeriler();
-  updateMotorVerileri();
-  updateSistemDurumu();
-  updateAlarmDurumlari();
-  lastUpdateTime = millis();
+  {
+    BusKilidi kilit(busKilidi);
+    
+    // Elektriksel, motor ve durum register'ları tek bir planla okunur
+    arka.HariciYakitSeviyesi = getHariciYakitSeviyesi();
+    enqueueRead<D300Map::TemelRegisterlar>(PLAN_TEMEL);
+    enqueueStep(&D300Map::ALARM_PLANI, &D300Controller::processAlarms);
+    drainReads();
+  }
+  refreshSnapshot();
   return connectionStatus;
 }
 
 bool D300Controller::updateData() {
   bool basicResult = updateBasicData();
-  updateSayaclar();
-  updateAnalogGirisler();
+  {
+    BusKilidi kilit(busKilidi);
+    enqueueRead<D300Map::EkRegisterlar>(PLAN_EK);
+    drainReads();
+  }
+  refreshSnapshot();
   return basicResult;
 }
 
+bool D300Controller::pollGroup(PollGrubu grup) {
+  {
+    BusKilidi kilit(busKilidi);
+    if (!enqueueGroup(grup)) return false;
+    drainReads();
+  }
+  refreshSnapshot();
+  return connectionStatus;
+}
+
+void D300Controller::setPollPeriod(PollGrubu grup, unsigned long periyot, uint16_t faz) {
+  uint8_t i = static_cast<uint8_t>(grup);
+  if (i >= POLL_GRUP_SAYISI) return;
+  pollZamani[i].periyot = periyot;
+  pollZamani[i].faz = faz;
+  pollZamani[i].sonrakiSlot = slotSayaci + faz;
+}
+
+uint32_t D300Controller::periodSlots(PollGrubu grup) const {
+  unsigned long periyot = pollZamani[static_cast<uint8_t>(grup)].periyot;
+  if (updateInterval == 0 || periyot <= updateInterval) return 1;
+  return periyot / updateInterval;
+}
+
+void D300Controller::runSchedulerSlot() {
+  int8_t secilen = -1;
+  
+  for (uint8_t i = 0; i < POLL_GRUP_SAYISI; i++) {
+    PollGrubu grup = static_cast<PollGrubu>(i);
+    
+    // Her slotta okunan gruplar
+    if (periodSlots(grup) == 1) {
+      enqueueGroup(grup);
+      continue;
+    }
+    
+    // Zamanı gelen yavaş gruplardan en çok geciken seçilir
+    if ((int32_t)(slotSayaci - pollZamani[i].sonrakiSlot) >= 0 &&
+        (secilen < 0 || (int32_t)(pollZamani[secilen].sonrakiSlot - pollZamani[i].sonrakiSlot) > 0)) {
+      secilen = i;
+    }
+  }
+  
+  if (secilen >= 0) {
+    PollGrubu grup = static_cast<PollGrubu>(secilen);
+    enqueueGroup(grup);
+    
+    // Fazı koruyarak bir sonraki slotu belirle; çok gerideyse yeniden hizala
+    PollZamani &zaman = pollZamani[secilen];
+    zaman.sonrakiSlot += periodSlots(grup);
+    if ((int32_t)(slotSayaci - zaman.sonrakiSlot) >= 0) {
+      zaman.sonrakiSlot = slotSayaci + periodSlots(grup);
+    }
+  }
+  
+  // Yerleşmesi tamamlanan harmonik kanalı bu slotun okumalarına eklenir
+  if (tarama.adim == TaramaAdimi::Yerlesiyor && millis() - tarama.zaman >= tarama.yerlesmeMs &&
+      enqueueStep(&D300Map::HARMONIK_PLANI, &D300Controller::processHarmonics)) {
+    tarama.adim = TaramaAdimi::Okunuyor;
+  }
+}
+
+// Harmonik taraması
+void D300Controller::setHarmonicSweep(bool etkin, unsigned long kanalAraligiMs, unsigned long yerlesmeMs) {
+  BusKilidi kilit(busKilidi);
+  tarama.etkin = etkin;
+  tarama.kanalAraligiMs = kanalAraligiMs;
+  tarama.yerlesmeMs = yerlesmeMs;
+  if (tarama.adim == TaramaAdimi::Bosta) {
+    tarama.zaman = millis() - kanalAraligiMs;   // İlk kanal hemen
+  }
+}
+
+void D300Controller::stepHarmonicSweep(unsigned long simdi) {
+  if (!tarama.etkin || !connectionStatus || tarama.adim != TaramaAdimi::Bosta) return;
+  if (simdi - tarama.zaman < tarama.kanalAraligiMs) return;
+  
+  if ((tarama.kanalMaskesi & (1UL << tarama.kanal)) == 0) {
+    // Maske değiştiyse taranan bir sonraki kanala geç
+    for (uint8_t i = 1; i <= HARMONIK_KANAL_SAYISI; i++) {
+      uint8_t k = (tarama.kanal + i) % HARMONIK_KANAL_SAYISI;
+      if (tarama.kanalMaskesi & (1UL << k)) {
+        tarama.kanal = k;
+        break;
+      }
+    }
+    if ((tarama.kanalMaskesi & (1UL << tarama.kanal)) == 0) return;
+  }
+  
+  if (queueCommand(8194, tarama.kanal, KomutOnceligi::Kontrol, onHarmonicChannelWritten, this)) {
+    tarama.adim = TaramaAdimi::KanalYaziliyor;
+    tarama.zaman = simdi;
+  }
+}
+
+void D300Controller::onHarmonicChannelWritten(void* baglam, const KomutSonucu& sonuc) {
+  D300Controller* self = static_cast<D300Controller*>(baglam);
+  HarmonikTarama &tarama = self->tarama;
+  tarama.zaman = millis();
+  if (sonuc.sonuc == ModbusSonuc::Basarili) {
+    tarama.adim = TaramaAdimi::Yerlesiyor;
+    return;
+  }
+  
+  // Hata: aynı kanal bir sonraki aralıkta tekrar denenir; istisna desteklenmiyor demektir
+  tarama.adim = TaramaAdimi::Bosta;
+  if (D300ModbusRtu::isIstisna(sonuc.sonuc)) {
+    tarama.etkin = false;
+  }
+}
+
+void D300Controller::processHarmonics(const D300Map::BlokPlani& plan, const bool* blokGecerli) {
+  tarama.adim = TaramaAdimi::Bosta;
+  tarama.zaman = millis();
+  if (!blokGecerli[0]) {
+    if (D300ModbusRtu::isIstisna(blokSonuc[0])) tarama.etkin = false;
+    return;
+  }
+  
+  // Cihaz başka bir kanalı gösteriyorsa (örn. ön panelden değiştirildi) değerler atılır,
+  // aynı kanal tekrar yazılır
+  const uint16_t* ham = &arka.Ham[D300Map::GORUNTU.ofsetBul(D300Map::HARMONIK_ADRESI, HARMONIK_REGISTER_SAYISI)];
+  if (ham[HARMONIK_REGISTER_SAYISI - 1] != tarama.kanal) return;
+  
+  HarmonikKanalVerisi &veri = arka.Harmonik[tarama.kanal];
+  memcpy(veri.Deger, ham, sizeof(veri.Deger));
+  veri.Zaman = tarama.zaman;
+  
+  for (uint8_t i = 1; i <= HARMONIK_KANAL_SAYISI; i++) {
+    uint8_t k = (tarama.kanal + i) % HARMONIK_KANAL_SAYISI;
+    if (tarama.kanalMaskesi & (1UL << k)) {
+      tarama.kanal = k;
+      break;
+    }
+  }
+}
+
+SabitNokta<2> D300Controller::getHarmonik(HarmonikKanal kanal, uint8_t derece) const {
+  const HarmonikKanalVerisi &veri = getHarmonikKanal(kanal);
+  uint8_t i;
+  if (derece <= 1) i = derece;
+  else if (derece % 2 == 1 && derece <= 31) i = 2 + (derece - 3) / 2;
+  else return SabitNokta<2>();
+  return SabitNokta<2>::hamdan(veri.Deger[i]);
+}
+
+void D300Controller::runAcquisition() {
+  BusKilidi kilit(busKilidi);
+  
+  // Devam eden okumayı ilerlet - hiçbir zaman cevap beklemez
+  pumpReads();
+  tickScheduler();
+  pumpReads();
+}
+
+void D300Controller::tickScheduler() {
+  unsigned long simdi = millis();
+  finishCancellations();
+  checkConfirmation(simdi);
+  
+  // Hat bu ünite için boşta kaldıysa (otomatik güncelleme kapalı ya da bağlantı
+  // kopuk) tek register'lık kimlik yoklaması yapılır; normal okumalar sürerken hiç yapılmaz
+  if (kuyrukAdet == 0 && simdi - sonIslem >= YOKLAMA_BEKLEMESI_MS) {
+    sonIslem = simdi;
+    enqueueStep(&D300Map::KIMLIK_PLANI, &D300Controller::processIdentity);
+    return;
+  }
+  
+  if (!autoUpdate) return;
+  
+  // Harmonik kanalı yazması slot beklemez; komut kuyruğundan gider
+  stepHarmonicSweep(simdi);
+  
+  if (simdi - lastSlotTime < updateInterval) return;
+  
+  // Kaçırılan slotlar telafi edilmez, sadece sayılır
+  uint32_t gecenSlot = updateInterval ? (simdi - lastSlotTime) / updateInterval : 1;
+  slotSayaci += (lastSlotTime == 0) ? 1 : gecenSlot;
+  lastSlotTime = simdi;
+  
+  // Önceki slotun okumaları bitmediyse bu slot atlanır, kuyruk büyümez.
+  // Kopuk ünite hattı zaman aşımlarıyla meşgul etmez; yoklama cevap alınca okumalar döner.
+  if (kuyrukAdet > 0 || !connectionStatus) return;
+  
+  runSchedulerSlot();
+}
+
+void D300Controller::acquisitionTask(void* arg) {
+  D300Controller* self = static_cast<D300Controller*>(arg);
+  for (;;) {
+    self->runAcquisition();
+    // Bir tik bekler; queueCommand() bildirimi görevi hemen uyandırır
+    ulTaskNotifyTake(pdTRUE, 1);
+  }
+}
+
+bool D300Controller::startTask(uint8_t cekirdek, uint32_t yiginBoyutu, uint8_t oncelik) {
+  if (yonetimli) return false;   // Görevi D300BusYoneticisi yürütür
+  if (edinimGorevi != nullptr) return true;
+  if (busKilidi == nullptr) {
+    busKilidi = xSemaphoreCreateRecursiveMutex();
+  }
+  return xTaskCreatePinnedToCore(acquisitionTask, "d300_edinim", yiginBoyutu, this,
+                                 oncelik, &edinimGorevi, cekirdek) == pdPASS;
+}
+
 void D300Controller::handle() {
-  if (autoUpdate && (millis() - lastUpdateTime >= updateInterval)) {
-    updateBasicData();
+  // Görev yoksa edinim burada, loop() içinde yürür
+  if (edinimGorevi == nullptr && !yonetimli) {
+    runAcquisition();
   }
+  refreshSnapshot();
 }
 
 // Kontrol komutları
-bool D300Controller::simulateButton(ButonMaski buton) {
-  uint8_t result = node.writeSingleRegister(8193, static_cast<uint16_t>(buton));
-  if (result == node.ku8MBSuccess) {
-    resetErrorCounter();
-    return true;
-  }
-  handleError();
-  return false;
+bool D300Controller::simulateButton(ButonMaski buton, KomutCallback callback, void* baglam) {
+  return queueCommand(8193, static_cast<uint16_t>(buton), KomutOnceligi::Mod, callback, baglam);
 }
 
-bool D300Controller::startGenerator() {
-  return simulateButton(ButonMaski::AUTO);
+bool D300Controller::startGenerator(KomutCallback callback, void* baglam) {
+  return simulateButton(ButonMaski::AUTO, callback, baglam);
 }
 
-bool D300Controller::stopGenerator() {
-  return simulateButton(ButonMaski::STOP);
+bool D300Controller::stopGenerator(KomutCallback callback, void* baglam) {
+  return simulateButton(ButonMaski::STOP, callback, baglam);
 }
 
-bool D300Controller::setAutoMode() {
-  return simulateButton(ButonMaski::AUTO);
+bool D300Controller::setAutoMode(KomutCallback callback, void* baglam) {
+  return simulateButton(ButonMaski::AUTO, callback, baglam);
 }
 
-bool D300Controller::setManualMode() {
-  return simulateButton(ButonMaski::MANUEL_RUN);
+bool D300Controller::setManualMode(KomutCallback callback, void* baglam) {
+  return simulateButton(ButonMaski::MANUEL_RUN, callback, baglam);
 }
 
-bool D300Controller::setTestMode() {
-  return simulateButton(ButonMaski::TEST);
+bool D300Controller::setTestMode(KomutCallback callback, void* baglam) {
+  return simulateButton(ButonMaski::TEST, callback, baglam);
 }
 
-bool D300Controller::emergencyStop() {
+bool D300Controller::emergencyStop(KomutCallback callback, void* baglam) {
   // Uzun basma ile acil durdurma
   uint16_t emergencyMask = static_cast<uint16_t>(ButonMaski::STOP) | 
                            static_cast<uint16_t>(ButonMaski::LONG_PRESS);
-  uint8_t result = node.writeSingleRegister(8193, emergencyMask);
-  if (result == node.ku8MBSuccess) {
-    resetErrorCounter();
-    return true;
-  }
-  handleError();
-  return false;
+  return queueCommand(8193, emergencyMask, KomutOnceligi::AcilDurdurma, callback, baglam);
 }
 
-bool D300Controller::resetUnit() {
-  uint8_t result = node.writeSingleRegister(8210, 14536);
-  if (result == node.ku8MBSuccess) {
-    resetErrorCounter();
-    return true;
+bool D300Controller::resetUnit(KomutCallback callback, void* baglam) {
+  return queueCommand(8210, 14536, KomutOnceligi::Kontrol, callback, baglam);
+}
+
+bool D300Controller::simulateButtonConfirmed(ButonMaski buton, OnayCallback callback, void* baglam,
+                                             unsigned long pencereMs) {
+  // Mod butonlarının maskesi UniteModu değeriyle aynıdır
+  uint16_t beklenenMod = 0;
+  switch (buton) {
+    case ButonMaski::STOP:
+    case ButonMaski::MANUEL_RUN:
+    case ButonMaski::AUTO:
+    case ButonMaski::TEST:
+      beklenenMod = static_cast<uint16_t>(buton);
+      break;
+    default:
+      break;
   }
-  handleError();
-  return false;
+  return queueConfirmedCommand(8193, static_cast<uint16_t>(buton), KomutOnceligi::Mod, beklenenMod,
+                               callback, baglam, pencereMs);
+}
+
+bool D300Controller::emergencyStopConfirmed(OnayCallback callback, void* baglam, unsigned long pencereMs) {
+  uint16_t emergencyMask = static_cast<uint16_t>(ButonMaski::STOP) | 
+                           static_cast<uint16_t>(ButonMaski::LONG_PRESS);
+  return queueConfirmedCommand(8193, emergencyMask, KomutOnceligi::AcilDurdurma,
+                               static_cast<uint16_t>(UniteModu::STOP), callback, baglam, pencereMs);
 }
 
 String D300Controller::buildJson() const {
-  String json = "{";
-  
-  // Temel durum bilgileri
-  json += "\"CalismaDurumu\":\"" + getDurumAciklama() + "\",";
-  json += "\"OperationMode\":" + String(static_cast<int>(Sistem.Mod)) + ",";
-  json += "\"SistemCalismaSuresi\":" + String(Sayac.MotorCalismaSaati * 3600) + ","; // Saati saniyeye çevir
-  
-  // Şebeke verileri
-  json += "\"SebekeVoltaj_l1\":" + String(ElektrikSistemi.Sebeke.L1.Voltaj, 1) + ",";
-  json += "\"SebekeVoltaj_l2\":" + String(ElektrikSistemi.Sebeke.L2.Voltaj, 1) + ",";
-  json += "\"SebekeVoltaj_l3\":" + String(ElektrikSistemi.Sebeke.L3.Voltaj, 1) + ",";
-  json += "\"SebekeHz\":" + String(ElektrikSistemi.Sebeke.Frekans, 1) + ",";
-  json += "\"ToplamGuc\":" + String(ElektrikSistemi.Sebeke.Toplam.AktifGuc * 1000, 1) + ","; // kW'tan W'a çevir
-  json += "\"SebekeDurumu\":" + String(isSebekeMevcut() ? "true" : "false") + ",";
-  
-  // Jeneratör verileri
-  json += "\"GenVoltaj_l1\":" + String(ElektrikSistemi.Jenerator.L1.Voltaj, 1) + ",";
-  json += "\"GenVoltaj_l2\":" + String(ElektrikSistemi.Jenerator.L2.Voltaj, 1) + ",";
-  json += "\"GenVoltaj_l3\":" + String(ElektrikSistemi.Jenerator.L3.Voltaj, 1) + ",";
-  json += "\"GenHz\":" + String(ElektrikSistemi.Jenerator.Frekans, 1) + ",";
-  json += "\"GenUretilenGuc\":" + String(ElektrikSistemi.Jenerator.Toplam.AktifGuc * 1000, 1) + ","; // kW'tan W'a çevir
-  
-  // Güç faktörü hesaplama
-  float gorunurGuc = sqrt(pow(ElektrikSistemi.Jenerator.Toplam.AktifGuc, 2) + 
-                         pow(ElektrikSistemi.Jenerator.Toplam.ReaktifGuc, 2));
-  float gucFaktoru = (gorunurGuc > 0) ? (ElektrikSistemi.Jenerator.Toplam.AktifGuc / gorunurGuc) * 100 : 0;
-  json += "\"GenGucFaktoru\":" + String(gucFaktoru, 1) + ",";
-  
-  // Motor verileri
-  json += "\"MotorRpm\":" + String(Motor.RPM, 0) + ",";
-  json += "\"MotorSicaklik\":" + String(Motor.Sicaklik, 1) + ",";
-  json += "\"YagBasinci\":" + String(Motor.YagBasinci, 1) + ",";
-  json += "\"YakitSeviyesi\":" + String(Motor.YakitSeviyesi, 1) + ",";
-  json += "\"BataryaVoltaji\":" + String(Motor.BataryaVoltaji, 1) + ",";
-  json += "\"timestamp\":" + String(millis());
-  
-  json += "}";
-  return json;
+  return jsonMetni([this](JsonYazici& j) { writeJson(j); });
 }
 
+void D300Controller::writeJson(JsonYazici& j) const {
+  D300Sema::yazJson<D300Sema::WebApi>(*this, j);
+}
 
-String D300Controller::getDurumAciklama() const {
-  switch (Sistem.Durum) {
+
+const char* D300Controller::getDurumMetni(UniteDurumu durum) {
+  switch (durum) {
     case UniteDurumu::JeneratorDinlenme: return "Jeneratör Dinlenme";
     case UniteDurumu::YakitOncesiBekleme: return "Yakıt Öncesi Bekleme";
     case UniteDurumu::MotorOnIsitma: return "Motor Ön Isıtma";
@@ -355,20 +1573,32 @@ String D300Controller::getDurumAciklama() const {
     case UniteDurumu::SogutmaliDurdurma: return "Soğutmalı Durdurma";
     case UniteDurumu::Soguyor: return "Soğuyor";
     case UniteDurumu::AcilDurdurma: return "Acil Durdurma";
-    default: return "Bilinmeyen (" + String(static_cast<uint16_t>(Sistem.Durum)) + ")";
+    default: return nullptr;
   }
 }
 
-String D300Controller::getModAciklama() const {
-  switch (Sistem.Mod) {
+String D300Controller::getDurumAciklama() const {
+  const char* metin = getDurumMetni(Sistem.Durum);
+  if (metin) return metin;
+  return "Bilinmeyen (" + String(static_cast<uint16_t>(Sistem.Durum)) + ")";
+}
+
+const char* D300Controller::getModMetni(UniteModu mod) {
+  switch (mod) {
     case UniteModu::STOP: return "STOP";
     case UniteModu::MANUEL: return "MANUEL";
     case UniteModu::AUTO: return "AUTO";
     case UniteModu::TEST: return "TEST";
-    default: return "Bilinmeyen (" + String(static_cast<uint16_t>(Sistem.Mod)) + ")";
+    default: return nullptr;
   }
 }
 
+String D300Controller::getModAciklama() const {
+  const char* metin = getModMetni(Sistem.Mod);
+  if (metin) return metin;
+  return "Bilinmeyen (" + String(static_cast<uint16_t>(Sistem.Mod)) + ")";
+}
+
 bool D300Controller::isAlarmActive(AlarmTipi tip) const {
   switch (tip) {
     case AlarmTipi::Kapatma: return Sistem.KapatmaAlarmi;
@@ -378,6 +1608,19 @@ bool D300Controller::isAlarmActive(AlarmTipi tip) const {
   }
 }
 
+bool D300Controller::isAlarmBitActive(uint16_t bit) const {
+  if (bit >= ALARM_KELIME_SAYISI * 16) return false;
+  return (Sistem.AlarmBitleri[bit / 16] >> (bit % 16)) & 1;
+}
+
+AlarmTipi D300Controller::getAlarmTipi(uint16_t bit) {
+  switch (bit / (ALARM_TIP_KELIME_SAYISI * 16)) {
+    case 0: return AlarmTipi::Kapatma;
+    case 1: return AlarmTipi::YukAtma;
+    default: return AlarmTipi::Uyari;
+  }
+}
+
 bool D300Controller::isJeneratorCalisir() const {
   return (Sistem.Durum >= UniteDurumu::MotorRolantiHizi && 
           Sistem.Durum <= UniteDurumu::SlaveJeneratorYuklu);
@@ -390,22 +1633,18 @@ bool D300Controller::isSebekeMevcut() const {
 }
 
 bool D300Controller::isSystemHealthy() const {
+  // Alarm durumu bilinmiyorsa sistem sağlıklı sayılmaz
   return connectionStatus && 
+         isAlarmVerisiTaze() &&
          !Sistem.KapatmaAlarmi && 
          Motor.BataryaVoltaji > 10.0 &&
          (Motor.YagBasinci > 0.5 || !isJeneratorCalisir());
 }
 
 bool D300Controller::isConnected() const {
-  uint16_t testValue;
-  D300Controller* nonConstThis = const_cast<D300Controller*>(this);
-  bool result = nonConstThis->read16BitValue(10609, testValue);
-  
-  // D-300 cihazları için beklenen kimlik değeri
-  if (result && (testValue == 0xD300 || testValue == 0xD500 || testValue == 0xD700)) {
-    return true;
-  }
-  return false;
+  // Bağlantı durumu okuma sonuçlarından güncellenir; son başarılı işlem
+  // eskiyse (görev durmuş, handle() çağrılmıyor) bağlı sayılmaz
+  return connectionStatus && millis() - sonBasariliIslem < BAYAT_BAGLANTI_MS;
 }
 
 void D300Controller::printAllData() const {
@@ -450,133 +1689,75 @@ void D300Controller::printSistemDurumu() const {
   Serial.printf("Bağlantı: %s | Sistem Sağlığı: %s\n", 
     connectionStatus ? "OK" : "HATA", 
     isSystemHealthy() ? "SAĞLIKLI" : "SORUNLU");
+  Serial.printf("Hat: %lu baud | %lu reg/sn | CRC hatası: %lu | Zaman aşımı: %lu\n",
+    (unsigned long)bus->getBaudRate(), (unsigned long)bus->getRegisterHizi(),
+    (unsigned long)bus->getCrcHatasi(), (unsigned long)bus->getZamanAsimiSayisi());
+  Serial.printf("Komut gecikmesi (max us): acil=%lu mod=%lu kontrol=%lu | Bekleyen: %u\n",
+    (unsigned long)getKomutGecikmesi(KomutOnceligi::AcilDurdurma).maxUs,
+    (unsigned long)getKomutGecikmesi(KomutOnceligi::Mod).maxUs,
+    (unsigned long)getKomutGecikmesi(KomutOnceligi::Kontrol).maxUs,
+    getBekleyenKomutSayisi());
 }
 
-String D300Controller::getDataAsJSON() const {
-  String json = "{";
-  json += "\"timestamp\":" + String(millis()) + ",";
-  json += "\"connected\":" + String(connectionStatus ? "true" : "false") + ",";
-  
-  // Elektriksel sistem
-  json += "\"electrical\":{";
-  json += "\"mains\":{";
-  json += "\"voltage\":{\"l1\":" + String(ElektrikSistemi.Sebeke.L1.Voltaj, 1) + 
-          ",\"l2\":" + String(ElektrikSistemi.Sebeke.L2.Voltaj, 1) + 
-          ",\"l3\":" + String(ElektrikSistemi.Sebeke.L3.Voltaj, 1) + "},";
-  json += "\"frequency\":" + String(ElektrikSistemi.Sebeke.Frekans, 1) + ",";
-  json += "\"power\":" + String(ElektrikSistemi.Sebeke.Toplam.AktifGuc, 1) + "},";
-  
-  json += "\"generator\":{";
-  json += "\"voltage\":{\"l1\":" + String(ElektrikSistemi.Jenerator.L1.Voltaj, 1) + 
-          ",\"l2\":" + String(ElektrikSistemi.Jenerator.L2.Voltaj, 1) + 
-          ",\"l3\":" + String(ElektrikSistemi.Jenerator.L3.Voltaj, 1) + "},";
-  json += "\"frequency\":" + String(ElektrikSistemi.Jenerator.Frekans, 1) + ",";
-  json += "\"power\":" + String(ElektrikSistemi.Jenerator.Toplam.AktifGuc, 1) + "}},";
-  
-  // Motor verileri
-  json += "\"engine\":{";
-  json += "\"rpm\":" + String(Motor.RPM, 0) + ",";
-  json += "\"temperature\":" + String(Motor.Sicaklik, 1) + ",";
-  json += "\"oil_pressure\":" + String(Motor.YagBasinci, 1) + ",";
-  json += "\"fuel_level\":" + String(Motor.YakitSeviyesi, 1) + ",";
-  json += "\"external_fuel_level\":" + String(Motor.HariciYakitSeviyesi, 1) + ",";  // Harici
-  json += "\"battery_voltage\":" + String(Motor.BataryaVoltaji, 1) + "},";
-  
-  // Sistem durumu
-  json += "\"system\":{";
-  json += "\"status\":" + String(static_cast<int>(Sistem.Durum)) + ",";
-  json += "\"mode\":" + String(static_cast<int>(Sistem.Mod)) + ",";
-  json += "\"alarms\":{";
-  json += "\"shutdown\":" + String(Sistem.KapatmaAlarmi ? "true" : "false") + ",";
-  json += "\"loaddump\":" + String(Sistem.YukAtmaAlarmi ? "true" : "false") + ",";
-  json += "\"warning\":" + String(Sistem.UyariAlarmi ? "true" : "false") + "}},";
-  
-  json += "\"healthy\":" + String(isSystemHealthy() ? "true" : "false");
-  json += "}";
-  
-  return json;
+void D300Controller::printHarmonikVerileri() const {
+  Serial.println("\n--- HARMONİK VERİLER ---");
+  for (uint8_t k = 0; k < HARMONIK_KANAL_SAYISI; k++) {
+    HarmonikKanal kanal = static_cast<HarmonikKanal>(k);
+    if (getHarmonikKanal(kanal).Zaman == 0) continue;
+    Serial.printf("Kanal %2u: THD %s%% | H3 %s%% | H5 %s%% | H7 %s%%\n", k,
+      getHarmonik(kanal, 0).toString().c_str(), getHarmonik(kanal, 3).toString().c_str(),
+      getHarmonik(kanal, 5).toString().c_str(), getHarmonik(kanal, 7).toString().c_str());
+  }
 }
 
-String D300Controller::getBasicDataAsJSON() const {
-  String json = "{";
-  json += "\"gen_power\":" + String(ElektrikSistemi.Jenerator.Toplam.AktifGuc, 1) + ",";
-  json += "\"gen_freq\":" + String(ElektrikSistemi.Jenerator.Frekans, 1) + ",";
-  json += "\"mains_freq\":" + String(ElektrikSistemi.Sebeke.Frekans, 1) + ",";
-  json += "\"rpm\":" + String(Motor.RPM, 0) + ",";
-  json += "\"battery\":" + String(Motor.BataryaVoltaji, 1) + ",";
-  json += "\"fuel\":" + String(Motor.YakitSeviyesi, 1) + ",";
-  json += "\"status\":" + String(static_cast<int>(Sistem.Durum)) + ",";
-  json += "\"mode\":" + String(static_cast<int>(Sistem.Mod)) + ",";
-  json += "\"alarms\":" + String((Sistem.KapatmaAlarmi || Sistem.YukAtmaAlarmi || Sistem.UyariAlarmi) ? "true" : "false") + ",";
-  json += "\"connected\":" + String(connectionStatus ? "true" : "false");
-  json += "}";
-  return json;
+String D300Controller::getDataAsJSON() const {
+  return jsonMetni([this](JsonYazici& j) { writeDataJson(j); });
 }
 
-void D300Controller::setSlaveID(uint8_t newSlaveID) {
-  if (newSlaveID >= 1 && newSlaveID <= 240) {
-    slaveID = newSlaveID;
-    node.begin(slaveID, *modbusSerial);
-  }
+void D300Controller::writeDataJson(JsonYazici& j) const {
+  D300Sema::yazJson<D300Sema::AyrintiliApi>(*this, j);
 }
 
+String D300Controller::getBasicDataAsJSON() const {
+  return jsonMetni([this](JsonYazici& j) { writeBasicDataJson(j); });
+}
 
-// D300Controller.cpp dosyasına eklenecek implementasyonlar:
-
-
+void D300Controller::writeBasicDataJson(JsonYazici& j) const {
+  D300Sema::yazJson<D300Sema::TemelApi>(*this, j);
+}
 
-// ADC okuma fonksiyonu
-float D300Controller::readFuelADC() {
-  long adcSum = 0;
-  
-  // Çoklu okuma ile noise filtreleme
-  for (int i = 0; i < ADC_SAMPLES; i++) {
-    adcSum += analogRead(FUEL_ADC_PIN);
-    delay(10);  // Örnekler arası gecikme
-  }
-  
-  float adcAverage = (float)adcSum / ADC_SAMPLES;
-  
-  // ADC değerini voltaja çevir
-  float adcVoltage = (adcAverage / ADC_MAX) * ESP32_VREF;
-  
-  // Yakıt seviyesini hesapla
-  return calculateFuelLevel(adcVoltage);
+String D300Controller::getHarmonicsAsJSON() const {
+  return jsonMetni([this](JsonYazici& j) { writeHarmonicsJson(j); });
 }
 
-// Voltage divider'dan yakıt seviyesi hesaplama
-float D300Controller::calculateFuelLevel(float adcVoltage) {
-  // Voltage divider formülü: Vout = Vin * (R_shamandra) / (R1 + R_shamandra)
-  // R_shamandra = (Vout * R1) / (Vin - Vout)
+void D300Controller::writeHarmonicsJson(JsonYazici& j) const {
+  // Sadece okunmuş kanallar; değerler % (2 basamak), yaş ms
+  unsigned long simdi = millis();
+  j.nesneBasla().alan("sweep", tarama.etkin).diziBasla("channels");
   
-  if (adcVoltage >= ESP32_VREF || adcVoltage <= 0) {
-    return -1; // Hata durumu
+  for (uint8_t k = 0; k < HARMONIK_KANAL_SAYISI; k++) {
+    const HarmonikKanalVerisi &veri = yerel.Harmonik[k];
+    if (veri.Zaman == 0) continue;
+    j.nesneBasla().alan("ch", k).alan("age", simdi - veri.Zaman).diziBasla("values");
+    for (uint8_t i = 0; i < HARMONIK_DEGER_SAYISI; i++) {
+      j.sabit(veri.Deger[i], 2);
+    }
+    j.diziBitir().nesneBitir();
   }
-  
-  // Şamandra direncini hesapla
-  float shamandraResistance = (adcVoltage * (R1 + R2)) / (ESP32_VREF - adcVoltage);
-  
-  // Direnci yakıt seviyesine çevir
-  return resistanceToFuelLevel(shamandraResistance);
+  j.diziBitir().nesneBitir();
 }
 
-// Direnç değerini yakıt yüzdesine çevirme
-float D300Controller::resistanceToFuelLevel(float resistance) {
-  // Linear interpolasyon
-  if (resistance <= FUEL_EMPTY_RESISTANCE) {
-    return 0.0;  // Tank boş
-  }
-  if (resistance >= FUEL_FULL_RESISTANCE) {
-    return 100.0;  // Tank dolu
+void D300Controller::setSlaveID(uint8_t newSlaveID) {
+  if (newSlaveID >= 1 && newSlaveID <= 240) {
+    slaveID = newSlaveID;
   }
-  
-  // Doğrusal olarak yakıt seviyesini hesapla
-  float fuelPercent = ((resistance - FUEL_EMPTY_RESISTANCE) / 
-                      (FUEL_FULL_RESISTANCE - FUEL_EMPTY_RESISTANCE)) * 100.0;
-  
-  return constrain(fuelPercent, 0.0, 100.0);
 }
 
+
+// D300Controller.cpp dosyasına eklenecek implementasyonlar:
+
+
+
 // Kalibrasyon fonksiyonu
 void D300Controller::calibrateFuelSensor(float emptyResistance, float fullResistance) {
   // Bu değerleri const olarak tanımladığımız için runtime'da değiştiremeyiz
@@ -11,8 +11,13 @@
 #include <Arduino.h>
 #endif
 
-#include <ModbusMaster.h>
 #include <HardwareSerial.h>
+#include <atomic>
+#include "D300ModbusRtu.h"
+#include "D300BlokPlani.h"
+#include "D300SabitNokta.h"
+#include "D300JsonYazici.h"
+#include "D300YakitSensoru.h"
 
 // Sistem durumu enum'ları
 enum class UniteDurumu : uint16_t {
@@ -74,6 +79,30 @@ enum class ButonMaski : uint16_t {
   VERY_LONG_PRESS = 0x8000
 };
 
+// Harmonik kanalı (8194'e yazılır, 10403'ten okunur)
+enum class HarmonikKanal : uint8_t {
+  SEBEKE_L1_VOLTAJ = 0,
+  SEBEKE_L2_VOLTAJ = 1,
+  SEBEKE_L3_VOLTAJ = 2,
+  JENERATOR_L1_VOLTAJ = 3,
+  JENERATOR_L2_VOLTAJ = 4,
+  JENERATOR_L3_VOLTAJ = 5,
+  SEBEKE_L1L2_VOLTAJ = 6,
+  SEBEKE_L2L3_VOLTAJ = 7,
+  SEBEKE_L3L1_VOLTAJ = 8,
+  JENERATOR_L1L2_VOLTAJ = 9,
+  JENERATOR_L2L3_VOLTAJ = 10,
+  JENERATOR_L3L1_VOLTAJ = 11,
+  SEBEKE_L1_AKIM = 12,
+  SEBEKE_L2_AKIM = 13,
+  SEBEKE_L3_AKIM = 14,
+  JENERATOR_L1_AKIM = 15,
+  JENERATOR_L2_AKIM = 16,
+  JENERATOR_L3_AKIM = 17,
+  SEBEKE_NEUTRAL_AKIM = 18,
+  JENERATOR_NEUTRAL_AKIM = 19
+};
+
 // Veri yapıları
 struct FazVerisi {
   float Voltaj = 0.0;
@@ -103,6 +132,12 @@ struct ElektrikselSistem {
   float FazVoltajL2L3 = 0.0;
   float FazVoltajL3L1 = 0.0;
   float NeutralAkim = 0.0;
+  
+  // Türetilmiş değerler: grubun her yeni okumasında bir kez hesaplanır
+  float VoltajDengesizligi = 0.0;   // %: ortalamadan en büyük sapma / ortalama
+  float AkimDengesizligi = 0.0;     // %
+  float FazFazSapmasi = 0.0;        // %: faz-faz voltajının √3 x faz-nötr'den en büyük sapması
+  float YukYuzdesi = 0.0;           // %: toplam aktif güç / nominal güç (setNominalGuc)
 };
 
 struct MotorVerileri {
@@ -120,6 +155,38 @@ struct MotorVerileri {
   float SarjAkimi = 0.0;
 };
 
+// Alarm register'ları: 10504-10519 kapatma, 10520-10535 yük atma, 10536-10551 uyarı
+static const uint16_t ALARM_BASLANGIC_ADRESI = 10504;
+static const uint8_t ALARM_KELIME_SAYISI = 48;
+static const uint8_t ALARM_TIP_KELIME_SAYISI = 16;
+
+// Register desteği tablosunun kapasitesi (D300Map::TumRegisterlar)
+static const uint8_t MAX_HARITA_REGISTER = 128;
+
+// Ham register görüntüsünün kapasitesi (D300Map::GORUNTU)
+static const uint16_t MAX_HAM_GORUNTU = 320;
+
+// Harmonik spektrumu: 10386 THD, 10387 temel, 10388-10402 H3-H31, 10403 seçili kanal
+static const uint8_t HARMONIK_KANAL_SAYISI = 20;
+static const uint8_t HARMONIK_REGISTER_SAYISI = 18;
+static const uint8_t HARMONIK_DEGER_SAYISI = 17;
+
+// Taramada bir kanalın son okunan spektrumu; değerler % x100
+struct HarmonikKanalVerisi {
+  uint16_t Deger[HARMONIK_DEGER_SAYISI] = {};    // [0] THD, [1] temel, [2 + i] H(3 + 2i)
+  uint32_t Zaman = 0;                            // millis(); 0 = henüz okunmadı
+};
+
+// Tek bir alarm bitinin değişimi
+struct AlarmOlayi {
+  uint16_t bit;               // 0-767: (register - 10504) * 16 + bit numarası
+  AlarmTipi tip;
+  bool aktif;                 // true = alarm oluştu, false = alarm kalktı
+  unsigned long zaman;        // millis()
+};
+
+typedef void (*AlarmCallback)(const AlarmOlayi& olay);
+
 struct SistemDurumu {
   UniteDurumu Durum = UniteDurumu::JeneratorDinlenme;
   UniteModu Mod = UniteModu::STOP;
@@ -129,6 +196,7 @@ struct SistemDurumu {
   bool KapatmaAlarmi = false;
   bool YukAtmaAlarmi = false;
   bool UyariAlarmi = false;
+  uint16_t AlarmBitleri[ALARM_KELIME_SAYISI] = {};
   uint16_t CihazKimlik = 0;
   uint16_t DonanımVersiyon = 0;
   uint16_t YazilimVersiyon = 0;
@@ -145,6 +213,7 @@ struct Sayaclar {
   float ToplamReaktifEnerjiInd = 0.0;
   float ToplamReaktifEnerjiCap = 0.0;
   float YakitSayaci = 0.0;
+  float FlowMeter = 0.0;
 };
 
 struct AnalogGirisler {
@@ -158,68 +227,403 @@ struct AnalogGirisler {
   uint16_t Analog8Deger = 0;
 };
 
-class D300Controller {
+struct GPS_Veriler {
+  float Enlem = 0.0;        // Latitude
+  float Boylam = 0.0;       // Longitude
+  float Yukseklik = 0.0;    // Altitude
+};
+
+struct IletisimVerileri {
+  uint16_t EthernetResetSayaci = 0;
+  uint16_t EthernetTCPPaketSayaci = 0;
+  uint32_t GPRS_IP = 0;
+};
+
+struct ElektrikSistemiVerisi {
+  ElektrikselSistem Sebeke;
+  ElektrikselSistem Jenerator;
+};
+
+// Bir alanın son okuma denemesinin sonucu
+enum class AlanKalitesi : uint8_t {
+  Yok,              // Hiç okunmadı ya da cihaz desteklemiyor
+  Iyi,
+  Bayat,            // Son başarılı okuma, grubun periyodunun çok gerisinde kaldı
+  Istisna,          // Son okumada cihaz istisna cevabı verdi
+  ZamanAsimi,       // Son okuma cevapsız kaldı
+  Hata              // CRC / geçersiz çerçeve
+};
+
+// Alan başına meta veri; indeks D300Map::TumRegisterlar'daki sıradır.
+// Son eleman alarm bitmap'ine aittir. Hatalı okumada değer korunur,
+// sadece kalite güncellenir - zaman son başarılı okumayı gösterir.
+static const uint8_t ALARM_META_INDEKSI = MAX_HARITA_REGISTER;
+struct AlanMetaVerisi {
+  uint32_t Zaman[MAX_HARITA_REGISTER + 1] = {};     // millis()
+  AlanKalitesi Kalite[MAX_HARITA_REGISTER + 1] = {};
+};
+
+// Register haritasının (D300RegisterMap.h) yazdığı veri kökü
+struct D300Veri {
+  ElektrikSistemiVerisi ElektrikSistemi;
+  MotorVerileri Motor;
+  SistemDurumu Sistem;
+  Sayaclar Sayac;
+  AnalogGirisler AnalogGiris;
+  GPS_Veriler GPS;
+  IletisimVerileri Iletisim;
+  AlanMetaVerisi Meta;
+};
+
+// Register desteği yoklama sonucu (probeRegisterSupport)
+enum class RegisterDestegi : uint8_t {
+  Bilinmiyor,       // Yoklanmadı veya hat hatası - okunmaya devam edilir
+  Destekleniyor,
+  Istisna,          // Cihaz istisna cevabı verdi - plandan çıkarılır
+  ZamanAsimi        // Cihaz hiç cevap vermedi - plandan çıkarılır
+};
+
+// Zamanlayıcının ayrı periyotlarla okuduğu register grupları
+enum class PollGrubu : uint8_t {
+  Elektrik,
+  Motor,
+  Durum,          // Durum register'ları ve alarmlar
+  Sayac,
+  Analog,
+  GPSIletisim,
+  ADET
+};
+
+// Edinim tarafının yayınladığı ham durum. Okumalar görüntüye doğrudan yapılır,
+// alan başına iş yoktur; D300Veri'nin register alanları okuyucu tarafında
+// sadece nesli değişen gruplar için çözülür.
+struct HamVeri {
+  uint16_t Ham[MAX_HAM_GORUNTU] = {};
+  uint32_t GrupNesli[static_cast<uint8_t>(PollGrubu::ADET)] = {};   // Grubun son başarılı okuması
+  AlanMetaVerisi Meta;
+  float HariciYakitSeviyesi = 0.0;
+  HarmonikKanalVerisi Harmonik[HARMONIK_KANAL_SAYISI];
+};
+
+// Komut öncelikleri; küçük değer önce gönderilir, okumalar hepsinden sonra gelir
+enum class KomutOnceligi : uint8_t {
+  AcilDurdurma,
+  Mod,              // Buton basımları ve mod değişimleri (8193)
+  Kontrol,          // Reset vb.
+  ADET
+};
+
+// Tamamlanan ya da iptal edilen bir komutun sonucu; zamanlar micros()
+struct KomutSonucu {
+  uint16_t adres;
+  uint16_t deger;
+  KomutOnceligi oncelik;
+  ModbusSonuc sonuc;
+  uint32_t kuyrukUs;          // Kuyruğa alındı
+  uint32_t hatUs;             // Hatta çıktı (iptalde 0)
+  uint32_t bitisUs;           // Cevap geldi / iptal edildi
+};
+
+typedef void (*KomutCallback)(void* baglam, const KomutSonucu& sonuc);
+
+// Öncelik başına kuyruktan hatta gecikme
+struct KomutGecikmesi {
+  uint32_t adet = 0;
+  uint32_t sonUs = 0;
+  uint32_t maxUs = 0;
+  uint64_t toplamUs = 0;
+};
+
+// Onaylı komutun sonucu
+enum class OnaySonucu : uint8_t {
+  Onaylandi,
+  ZamanAsimi,       // Pencere içinde beklenen geçiş görülmedi
+  YazmaHatasi,      // Cihaz yazmayı kabul etmedi
+  Iptal             // Kuyrukta iptal edildi ya da yerine yeni onaylı komut geldi
+};
+
+// Onaylı komut raporu; durum ve mod 10604/10605'ten
+struct KomutOnayi {
+  KomutSonucu komut;
+  OnaySonucu sonuc;
+  UniteDurumu oncekiDurum;
+  UniteModu oncekiMod;
+  UniteDurumu yeniDurum;
+  UniteModu yeniMod;
+  unsigned long yazmaZamani;    // millis(): yazmanın kabulü
+  unsigned long onayZamani;     // millis(): geçişin görüldüğü okuma ya da pencerenin sonu
+  uint16_t okumaSayisi;         // Pencerede yapılan durum okuması
+};
+
+typedef void (*OnayCallback)(void* baglam, const KomutOnayi& onay);
+
+class D300BusYoneticisi;
+
+class D300Controller : public D300Veri {
+  friend class D300BusYoneticisi;
+  
 private:
-  ModbusMaster node;
+  D300ModbusRtu* bus;
+  bool yonetimli;                   // Hat D300BusYoneticisi'ne ait
   HardwareSerial* modbusSerial;
   uint8_t slaveID;
   unsigned long lastUpdateTime;
-  unsigned long updateInterval;
+  unsigned long updateInterval;     // Zamanlayıcı slot süresi
+  unsigned long lastSlotTime;
+  uint32_t slotSayaci;
   bool autoUpdate;
   bool connectionStatus;
   uint8_t consecutiveErrors;
   static const uint8_t MAX_ERRORS = 5;
   
+  // Bağlantı modeli: normal okumaların sonuçlarından beslenir, ek istek gerektirmez.
+  // Skor her işlemde üstel olarak başarıya (1) ya da hataya (0) yaklaşır.
+  static constexpr float SKOR_KATSAYISI = 0.25f;
+  static constexpr float MIN_BAGLANTI_SKORU = 0.2f;
+  static const unsigned long YOKLAMA_BEKLEMESI_MS = 2000;   // Bu kadar işlem yoksa kimlik okunur
+  static const unsigned long BAYAT_BAGLANTI_MS = 5000;      // Son başarılı işlem bundan eskiyse bağlı değil
+  float baglantiSkoru;
+  unsigned long sonBasariliIslem;
+  unsigned long sonIslem;
+  AlarmCallback alarmCallback;
+  
+  // Register desteği yoklaması ve bloklayan okumalar için tampon;
+  // zamanlanmış okumalar doğrudan ham görüntüye yapılır
+  static const uint16_t BLOK_TAMPON_BOYUTU = D300ModbusRtu::MAX_REGISTER;
+  uint16_t blokTampon[BLOK_TAMPON_BOYUTU];
+  
   // Private fonksiyonlar
   bool read32BitValue(uint16_t address, uint32_t &value);
   bool read16BitValue(uint16_t address, uint16_t &value);
   bool readFloat32(uint16_t address, float &value, int coefficient);
   bool readFloat16(uint16_t address, float &value, int coefficient);
+  bool readMultipleRegisters(uint16_t address, uint16_t quantity, uint16_t* buffer);
+  
+  // Çok hızlı zamanlayıcı: her grubun kendi periyodu ve fazı vardır.
+  // Periyodu bir slot olan gruplar her slotta, diğerleri ise slot başına
+  // en fazla bir tane olacak şekilde (en çok geciken önce) okunur.
+  static const uint8_t POLL_GRUP_SAYISI = static_cast<uint8_t>(PollGrubu::ADET);
+  struct PollZamani {
+    unsigned long periyot;   // ms
+    uint16_t faz;            // İlk okuma slotu
+    uint32_t sonrakiSlot;
+  };
+  PollZamani pollZamani[POLL_GRUP_SAYISI];
+  
+  uint32_t periodSlots(PollGrubu grup) const;
+  void runSchedulerSlot();
+  
+  // Asenkron okuma kuyruğu: her adım bir blok planını istek istek okur,
+  // son blok tamamlanınca adımın işleyicisi tamponu veri yapılarına çözer.
+  typedef void (D300Controller::*AdimIsleyici)(const D300Map::BlokPlani& plan, const bool* blokGecerli);
+  struct OkumaAdimi {
+    const D300Map::BlokPlani* plan;
+    AdimIsleyici isle;
+  };
+  static const uint8_t MAX_OKUMA_ADIMI = 8;
+  static const uint8_t MAX_ADIM_BLOK = 8;
+  OkumaAdimi okumaKuyrugu[MAX_OKUMA_ADIMI];
+  uint8_t kuyrukBas;
+  uint8_t kuyrukAdet;
+  uint8_t aktifBlok;
+  bool blokBekleniyor;
+  bool blokGecerli[MAX_ADIM_BLOK];
+  ModbusSonuc blokSonuc[MAX_ADIM_BLOK];
+  bool sonAdimBasarili;
+  
+  bool enqueueStep(const D300Map::BlokPlani* plan, AdimIsleyici isle);
+  bool enqueueGroup(PollGrubu grup);
+  template <typename Grup> bool enqueueRead(uint8_t planNo);
+  void pumpReads();
+  void completeSteps();
+  bool startNextBlock();
+  bool hasPendingBlock() const;
+  bool drainReads();
+  static void onBlockComplete(void* baglam, ModbusSonuc sonuc);
+  
+  // Adım işleyicileri
+  template <typename Grup> void commitGroup(const D300Map::BlokPlani& plan, const bool* blokGecerli);
+  void processMotor(const D300Map::BlokPlani& plan, const bool* blokGecerli);
+  void processAlarms(const D300Map::BlokPlani& plan, const bool* blokGecerli);
+  void processIdentity(const D300Map::BlokPlani& plan, const bool* blokGecerli);
+  template <typename Grup> void markFields(const D300Map::BlokPlani& plan);
+  void markField(uint8_t indeks, ModbusSonuc sonuc, unsigned long zaman);
+  
+  // Bayatlık sınırı için her alanın okunduğu poll grubu
+  static const uint8_t BAYAT_PERIYOT_KATSAYISI = 3;
+  uint8_t alanGrubu[MAX_HARITA_REGISTER];
+  template <typename Grup> void assignFieldGroup(PollGrubu grup);
+  unsigned long staleLimit(uint8_t indeks) const;
+  bool probeLink();
+  
+  // Harmonik taraması: kanal 8194'e komut kuyruğu üzerinden yazılır, cihazın
+  // yeni kanalı hesaplaması beklenir, spektrum bir zamanlayıcı slotunun
+  // okumalarına eklenip tek blokta okunur. Kanal başına bir yazma ve bir okuma.
+  enum class TaramaAdimi : uint8_t {
+    Bosta,
+    KanalYaziliyor,
+    Yerlesiyor,
+    Okunuyor
+  };
+  struct HarmonikTarama {
+    bool etkin;
+    TaramaAdimi adim;
+    uint8_t kanal;
+    uint32_t kanalMaskesi;          // Bit n = kanal n taranır
+    unsigned long kanalAraligiMs;   // İki kanal arası
+    unsigned long yerlesmeMs;       // Kanal yazıldıktan sonra okumaya kadar
+    unsigned long zaman;            // Adımın başladığı an (millis)
+  };
+  HarmonikTarama tarama;
+  
+  void stepHarmonicSweep(unsigned long simdi);
+  void processHarmonics(const D300Map::BlokPlani& plan, const bool* blokGecerli);
+  static void onHarmonicChannelWritten(void* baglam, const KomutSonucu& sonuc);
+  
+  // Register desteği ve çalışma zamanı planları: desteklenmeyen alanlar
+  // planlardan çıkarılır, böylece okuma turları onlara hiç istek göndermez.
+  // Bloklar yalnızca okunduğu doğrulanmış boşlukların üzerinden birleşir;
+  // desteklenmeyen alan ya da okunamayan boşluk blok sınırı olur.
+  static const uint8_t PLAN_TEMEL = POLL_GRUP_SAYISI;       // updateBasicData()
+  static const uint8_t PLAN_EK = POLL_GRUP_SAYISI + 1;      // updateData() ek okuması
+  static const uint8_t PLAN_SAYISI = POLL_GRUP_SAYISI + 2;
+  RegisterDestegi registerDestegi[MAX_HARITA_REGISTER];
+  RegisterDestegi boslukDestegi[MAX_HARITA_REGISTER];   // Sıralı haritada i. alan ile sonraki arası
+  D300Map::BlokPlani planlar[PLAN_SAYISI];
+  
+  void rebuildPlans();
+  void probeRange(uint8_t bas, uint8_t son);
+  void probeGaps();
+  bool isRegisterSupported(uint16_t adres) const;
+  bool isGapReadable(uint16_t bas, uint16_t son) const;
+  
+  // Komut kuyruğu: yazmalar okuma bloklarının önüne geçer. Hatta aynı anda tek
+  // çerçeve olduğundan bir komutun en kötü bekleyişi, o an hatta olan çerçevenin
+  // (en fazla 125 register'lık bir blok ya da onun zaman aşımı) kalanıdır.
+  static const uint8_t KOMUT_ONCELIK_SAYISI = static_cast<uint8_t>(KomutOnceligi::ADET);
+  static const uint8_t MAX_KOMUT = 8;
+  struct BekleyenKomut {
+    KomutSonucu s;
+    KomutCallback callback;
+    void* baglam;
+    uint32_t sira;                  // Aynı öncelikte geliş sırası
+    int8_t esi;                     // Aynı yazmayı bekleyen kopyanın asıl yuvası, asılsa -1
+    bool iptal;                     // İptal edildi; sonucu edinim bağlamında verilir
+    bool dolu;
+  };
+  BekleyenKomut komutlar[MAX_KOMUT];
+  int8_t aktifKomut;                // Hattaki komutun yuvası, yoksa -1
+  uint32_t komutSirasi;
+  KomutGecikmesi komutGecikmesi[KOMUT_ONCELIK_SAYISI];
+  
+  int8_t nextCommand() const;
+  int8_t pendingCommandPriority() const;
+  bool startNextCommand();
+  void finishCommand(BekleyenKomut& komut, ModbusSonuc sonuc, uint32_t zaman);
+  void finishCancellations();
+  static void onCommandComplete(void* baglam, ModbusSonuc sonuc);
+  
+  // Komut onayı: yazma kabul edilince durum ve mod pencere boyunca, okuma
+  // bloklarıyla dönüşümlü olarak (blok yoksa art arda) okunur. Genel okuma
+  // periyotları değişmez. Ünite başına tek onay izlenir.
+  struct AktifOnay {
+    bool aktif;
+    bool yazildi;               // Yazma kabul edildi, okumalar başladı
+    bool okumaBekleniyor;
+    bool araVer;                // Sıradaki çerçeve bekleyen okuma bloğuna bırakılır
+    uint16_t beklenenMod;       // 0: durum ya da moddaki herhangi bir değişim
+    unsigned long pencereMs;
+    unsigned long baslangic;    // millis(): yazmanın kabulü
+    OnayCallback callback;
+    void* baglam;
+    KomutOnayi rapor;
+  };
+  AktifOnay onay;
+  
+  // Yerine yenisi gelen onaylı komutların iptal raporları; callback'ler
+  // çağıranın bağlamında değil, sonraki edinim turunda çağrılır
+  static const uint8_t MAX_IPTAL_ONAY = 4;
+  struct IptalOnay {
+    KomutOnayi rapor;
+    OnayCallback callback;
+    void* baglam;
+  };
+  IptalOnay iptalOnaylari[MAX_IPTAL_ONAY];
+  uint8_t iptalOnayAdet;
+  
+  bool queueConfirmedCommand(uint16_t adres, uint16_t deger, KomutOnceligi oncelik, uint16_t beklenenMod,
+                             OnayCallback callback, void* baglam, unsigned long pencereMs);
+  bool confirmationDue() const;
+  bool startConfirmationRead();
+  void checkConfirmation(unsigned long zaman);
+  KomutOnayi closeConfirmation(OnaySonucu sonuc, unsigned long zaman);
+  void finishConfirmation(OnaySonucu sonuc, unsigned long zaman);
+  static void onConfirmedCommand(void* baglam, const KomutSonucu& sonuc);
+  static void onConfirmationRead(void* baglam, ModbusSonuc sonuc);
+  
+  // Çift tamponlu veri: okumalar 'arka' ham görüntüye yapılır, kuyruk boşalınca
+  // tamamlanan tur seqlock ile 'yayin'a kopyalanır. Okuyucu 'yerel'e kopyalar
+  // ve D300Veri tabanına sadece nesli değişen grupları çözer (handle() içinde).
+  HamVeri arka;
+  HamVeri yayin;
+  HamVeri yerel;
+  std::atomic<uint32_t> yayinSira;
+  uint32_t yerelSira;
+  uint32_t okumaNesli;
+  uint32_t cozulenNesil[POLL_GRUP_SAYISI];
+  uint16_t alarmBitleri[ALARM_KELIME_SAYISI];   // Olay üretimi için önceki alarm durumu
+  
+  uint32_t copyPublished(HamVeri& hedef) const;
   
-  void updateElektrikselVeriler();
-  void updateMotorVerileri();
-  void updateSistemDurumu();
-  void updateSayaclar();
-  void updateAnalogGirisler();
-  void updateAlarmDurumlari();
+  // Değişim algılama (okuyucu tarafı, yeniden çözülen gruplar için): ölü bandı
+  // aşan her değişim alanın kirli bitini kurar ve yeni bir değişim nesli alır.
+  // Karşılaştırma ham tamsayılarla, son bildirilen değere göre yapılır.
+  uint32_t oluBantMutlak[MAX_HARITA_REGISTER];      // Ham birimde
+  uint16_t oluBantBinde[MAX_HARITA_REGISTER];       // Son bildirilen değerin bindesi
+  uint32_t bildirilenHam[MAX_HARITA_REGISTER];
+  uint16_t bildirilenAlarmlar[ALARM_KELIME_SAYISI];
+  uint32_t alanDegisimNesli[MAX_HARITA_REGISTER + 1];
+  uint32_t kirliBitler[(MAX_HARITA_REGISTER + 1 + 31) / 32];
+  uint32_t degisimNesli;
+  
+  void detectChanges(uint8_t grupMaskesi);
+  void decodeImage(D300Veri& hedef, const HamVeri& kaynak, uint32_t* cozulenNesil) const;
+  
+  // Türetilmiş büyüklükler (görünür güç, güç faktörü, dengesizlik, faz-faz
+  // tutarlılığı, yük yüzdesi) çözümde hesaplanır; serileştiriciler hesap yapmaz
+  float nominalGucKw[2];            // [0] şebeke, [1] jeneratör; 0 = bilinmiyor
+  static void deriveMetrics(ElektrikselSistem& sistem, float nominalGuc);
+  
+  // Edinim görevi (startTask) ve hat kilidi
+  TaskHandle_t edinimGorevi;        // Yönetimlide D300BusYoneticisi'nin görevi
+  SemaphoreHandle_t busKilidi;
+  
+  void publishSnapshot();
+  void refreshSnapshot();
+  void runAcquisition();
+  void tickScheduler();
+  void initCommon();
+  static void acquisitionTask(void* arg);
   
   void handleError();
+  void recordResult(ModbusSonuc sonuc);
   void resetErrorCounter();
 /*
 */
-  // ADC yakıt sensörü için yeni değişkenler
-  const uint8_t FUEL_ADC_PIN = 34;
-  const int ADC_SAMPLES = 10;          // Ortalama alma için sample sayısı
-  const float R1 = 680.0;             // Alt direnç (ohm)
-  const float R2 = 4700.0;            // Üst direnç (ohm)
-  const float VCC = 5.0;              // Besleme voltajı
-  const float ADC_MAX = 4095.0;       // 12-bit ADC maksimum değeri
-  const float ESP32_VREF = 3.3;       // ESP32 referans voltajı
-  
-  // Şamandra kalibrasyonu (bu değerleri yakıt tankınıza göre ayarlayın)
-  const float FUEL_EMPTY_RESISTANCE = 10.0;    // Boş tank direnci (ohm)
-  const float FUEL_FULL_RESISTANCE = 180.0;    // Dolu tank direnci (ohm)
-  
-  // ADC fonksiyonları
-  float readFuelADC();
-  float calculateFuelLevel(float adcVoltage);
-  float resistanceToFuelLevel(float resistance);
+  // Harici şamandra: tek başına kullanımda kontrolcüye, paylaşılan hatta
+  // yöneticiye aittir (D300YakitSensoru.h)
+  D300YakitSensoru* yakitSensoru;
 
 
 public:
-  // Public veri yapıları
-  struct {
-    ElektrikselSistem Sebeke;
-    ElektrikselSistem Jenerator;
-  } ElektrikSistemi;
-  
-  MotorVerileri Motor;
-  SistemDurumu Sistem;
-  Sayaclar Sayac;
-  AnalogGirisler AnalogGiris;
+  // Public veri yapıları D300Veri'den gelir:
+  // ElektrikSistemi, Motor, Sistem, Sayac, AnalogGiris
+  // Bu alanlar loop() tarafının tutarlı kopyasıdır; başka görevler getSnapshot() kullanmalı.
   
   /**/
- float getHariciYakitSeviyesi() const { return Motor.HariciYakitSeviyesi; }
+  // Filtrenin son çıktısı; beklemez, her çağrıda sabit sürede döner
+  float getHariciYakitSeviyesi() const { return yakitSensoru ? yakitSensoru->getSeviye() : 0.0f; }
+  uint32_t getYakitOrnekSayisi() const { return yakitSensoru ? yakitSensoru->getOrnekSayisi() : 0; }
   
   // Kalibasyon fonksiyonları
   void calibrateFuelSensor(float emptyResistance, float fullResistance);
@@ -229,31 +633,129 @@ public:
 
   // Constructor
   D300Controller(uint8_t slaveID = 1, uint8_t rxPin = 16, uint8_t txPin = 17);
+  // Paylaşılan hat üzerindeki ünite (D300BusYoneticisi::addUnit kullanır)
+  D300Controller(D300ModbusRtu& paylasilanBus, SemaphoreHandle_t kilit, uint8_t slaveID,
+                 D300YakitSensoru* yakitSensoru = nullptr);
+  
+  // begin(BAUD_OTOMATIK) cihazın ayarlı olduğu en hızlı baud'u bulur
+  static const uint32_t BAUD_OTOMATIK = 0;
   
   // Ana fonksiyonlar
-  bool begin(uint32_t baudRate = 9600, unsigned long updateInterval = 5000);
+  bool begin(uint32_t baudRate = 9600, unsigned long updateInterval = 250);
   bool updateData();
   bool updateBasicData();
+  bool pollGroup(PollGrubu grup);
   void handle();
   
-  // Kontrol fonksiyonları
-  bool simulateButton(ButonMaski buton);
-  bool startGenerator();
-  bool stopGenerator();
-  bool setAutoMode();
-  bool setManualMode();
-  bool setTestMode();
-  bool emergencyStop();
-  bool resetUnit();
+  // Edinimi ayrı bir çekirdekteki göreve taşır; handle() sadece anlık görüntüyü yeniler.
+  // Görev modunda alarm callback'i edinim görevinden çağrılır.
+  bool startTask(uint8_t cekirdek = 0, uint32_t yiginBoyutu = 4096, uint8_t oncelik = 2);
+  // Herhangi bir görevden tutarlı kopya; yayını ara tampon kullanmadan hedefe çözer
+  uint32_t getSnapshot(D300Veri& hedef) const;
+  
+  // Register desteği: begin() sonuçları CihazKimlik/YazilimVersiyon anahtarıyla
+  // NVS'ten yükler, yoksa cihazı yoklar. zorla = true önbelleği yok sayar.
+  bool probeRegisterSupport(bool zorla = false);
+  RegisterDestegi getRegisterDestegi(uint16_t adres) const;
+  uint8_t getDesteklenmeyenSayisi() const;
+  
+  // Alan kalitesi ve tazeliği (anlık görüntüden). Bayat, okuma anında değil
+  // sorgu anında belirlenir; grubun periyodunun 3 katı süre başarılı okuma yoksa.
+  AlanKalitesi getAlanKalitesi(uint16_t adres) const;
+  unsigned long getAlanYasi(uint16_t adres) const;     // ms; hiç okunmadıysa ULONG_MAX
+  bool isAlarmVerisiTaze() const;
+  // Haritadaki alanlar adrese göre sıralı; i < getAlanSayisi()
+  static uint8_t getAlanSayisi();
+  static uint16_t getAlanAdresi(uint8_t i);
+  
+  // Ham register görüntüsü (anlık görüntüden); adres -> ofset getHamOfset() ile
+  const uint16_t* getHamGoruntu() const { return yerel.Ham; }
+  static uint16_t getHamGoruntuBoyutu();
+  static int16_t getHamOfset(uint16_t adres, uint8_t genislik = 1);
+  uint32_t getGrupNesli(PollGrubu grup) const { return yerel.GrupNesli[static_cast<uint8_t>(grup)]; }
+  
+  // Harmonik taraması (varsayılan kapalı). Tam tarama süresi yaklaşık
+  // kanal sayısı x kanalAraligiMs'dir; cihaz harmonik register'larını
+  // desteklemiyorsa tarama kendiliğinden durur.
+  static const uint32_t TUM_HARMONIK_KANALLARI = (1UL << HARMONIK_KANAL_SAYISI) - 1;
+  void setHarmonicSweep(bool etkin, unsigned long kanalAraligiMs = 1000, unsigned long yerlesmeMs = 500);
+  void setHarmonicChannelMask(uint32_t maske) { tarama.kanalMaskesi = maske & TUM_HARMONIK_KANALLARI; }
+  bool isHarmonicSweepEnabled() const { return tarama.etkin; }
+  const HarmonikKanalVerisi& getHarmonikKanal(HarmonikKanal kanal) const {
+    return yerel.Harmonik[static_cast<uint8_t>(kanal) % HARMONIK_KANAL_SAYISI];
+  }
+  // derece: 0 = THD, 1 = temel, 3..31 tek harmonikler; diğerleri 0
+  SabitNokta<2> getHarmonik(HarmonikKanal kanal, uint8_t derece) const;
+  
+  // Register'ın sabit noktalı değeri, örn. getSabit<10246>() -> SabitNokta<1> (230.1 V).
+  // Tanımı D300RegisterMap.h'dedir; kullanan dosya onu da include etmeli.
+  template <uint16_t Adres> auto getSabit() const;
+  
+  // Değişim algılama. Ölü bant: değişim hem mutlak hem bağıl sınırı aşmalı
+  // (0 = sınır yok). Yayıncılar getDegisimNesli() ile bir nesil saklar ve
+  // sonraki gönderimde sadece o nesilden sonra değişen alanları yollar.
+  static const uint8_t KIRLI_KELIME_SAYISI = (MAX_HARITA_REGISTER + 1 + 31) / 32;
+  void setDeadband(uint16_t adres, float mutlak, float bagilYuzde = 0.0f);
+  uint32_t getDegisimNesli() const { return degisimNesli; }
+  bool isAlanDegisti(uint16_t adres, uint32_t nesil) const;
+  uint8_t getDegisenAlanlar(uint32_t nesil, uint32_t* bitler) const;
+  const uint32_t* getKirliBitler() const { return kirliBitler; }
+  void clearKirliBitler() { memset(kirliBitler, 0, sizeof(kirliBitler)); }
+  String getChangesAsJSON(uint32_t nesil) const;
+  void writeChangesJson(JsonYazici& j, uint32_t nesil) const;
+  static const char* getKaliteAciklama(AlanKalitesi kalite);
+  
+  // Komut kuyruğu. Komutlar bir sonraki okuma bloğundan önce, öncelik sırasıyla
+  // gönderilir; fonksiyonlar beklemeden döner ve sonuç callback ile gelir.
+  // Edinim görevi varsa komut yalnızca kuyruğa alınıp görev uyandırılır; iptaller
+  // dahil tüm callback'ler görevden gelir. Görev yoksa hat boştaysa komut hemen
+  // gönderilir ve callback'ler çağıranın bağlamında, bu fonksiyonun ya da
+  // handle()'ın içinde çalışabilir. Kuyrukta bekleyen aynı komut ikinci kez
+  // yazılmaz; sonradan gelenin callback'i ilk yazmanın sonucuyla çağrılır.
+  // Acil durdurma, henüz gönderilmemiş buton komutlarını iptal eder.
+  // Kuyruk doluysa false döner.
+  bool queueCommand(uint16_t adres, uint16_t deger, KomutOnceligi oncelik,
+                    KomutCallback callback = nullptr, void* baglam = nullptr);
+  uint8_t getBekleyenKomutSayisi() const;
+  const KomutGecikmesi& getKomutGecikmesi(KomutOnceligi oncelik) const {
+    return komutGecikmesi[static_cast<uint8_t>(oncelik)];
+  }
+  void resetKomutGecikmesi();
+  
+  // Kontrol fonksiyonları (komut kuyruğu üzerinden)
+  bool simulateButton(ButonMaski buton, KomutCallback callback = nullptr, void* baglam = nullptr);
+  bool startGenerator(KomutCallback callback = nullptr, void* baglam = nullptr);
+  bool stopGenerator(KomutCallback callback = nullptr, void* baglam = nullptr);
+  bool setAutoMode(KomutCallback callback = nullptr, void* baglam = nullptr);
+  bool setManualMode(KomutCallback callback = nullptr, void* baglam = nullptr);
+  bool setTestMode(KomutCallback callback = nullptr, void* baglam = nullptr);
+  bool emergencyStop(KomutCallback callback = nullptr, void* baglam = nullptr);
+  bool resetUnit(KomutCallback callback = nullptr, void* baglam = nullptr);
+  
+  // Onaylı komutlar: sonuç, cihazın durumu/modu değiştiğinde ya da pencere
+  // dolduğunda zaman damgasıyla gelir. Mod butonlarında (STOP, MANUEL_RUN, AUTO,
+  // TEST) ve acil durdurmada beklenen mod, diğerlerinde herhangi bir değişim aranır.
+  static const unsigned long ONAY_PENCERESI_MS = 3000;
+  bool simulateButtonConfirmed(ButonMaski buton, OnayCallback callback, void* baglam = nullptr,
+                               unsigned long pencereMs = ONAY_PENCERESI_MS);
+  bool emergencyStopConfirmed(OnayCallback callback, void* baglam = nullptr,
+                              unsigned long pencereMs = ONAY_PENCERESI_MS);
+  bool isOnayBekleniyor() const { return onay.aktif; }
   // JSON veri oluşturma
   String buildJson() const;
+  void writeJson(JsonYazici& j) const;
   // Durum kontrol fonksiyonları
   String getDurumAciklama() const;
   String getModAciklama() const;
+  static const char* getDurumMetni(UniteDurumu durum);   // Bilinmeyende nullptr
+  static const char* getModMetni(UniteModu mod);
   bool isAlarmActive(AlarmTipi tip) const;
+  bool isAlarmBitActive(uint16_t bit) const;
+  static AlarmTipi getAlarmTipi(uint16_t bit);
   bool isJeneratorCalisir() const;
   bool isSebekeMevcut() const;
   bool isSystemHealthy() const;
+  // Son işlem sonuçlarından hesaplanır; hatta istek göndermez
   bool isConnected() const;
   
   // Debug fonksiyonları
@@ -261,13 +763,23 @@ public:
   void printElektrikselVeriler() const;
   void printMotorVerileri() const;
   void printSistemDurumu() const;
+  void printHarmonikVerileri() const;
   
-  // JSON çıktı
+  // JSON çıktı. write* sürümleri heap kullanmaz: yazıcı çağıranın tamponuna
+  // ya da parça parça bir ağ çıkışına yazar. String sürümleri bunları sarar.
+  // Alanlar, birimleri ve basamakları D300Sema.h'deki şemalardan gelir:
+  // writeJson web API (güç W), writeDataJson ayrıntılı, writeBasicDataJson özet.
   String getDataAsJSON() const;
   String getBasicDataAsJSON() const;
+  String getHarmonicsAsJSON() const;
+  void writeDataJson(JsonYazici& j) const;
+  void writeBasicDataJson(JsonYazici& j) const;
+  void writeHarmonicsJson(JsonYazici& j) const;
   
   // Hızlı erişim getters
   float getJeneratorGuc() const { return ElektrikSistemi.Jenerator.Toplam.AktifGuc; }
+  float getJeneratorGucFaktoru() const { return ElektrikSistemi.Jenerator.Toplam.GucFaktoru; }
+  float getYukYuzdesi() const { return ElektrikSistemi.Jenerator.YukYuzdesi; }
   float getSebekeFrekans() const { return ElektrikSistemi.Sebeke.Frekans; }
   float getJeneratorFrekans() const { return ElektrikSistemi.Jenerator.Frekans; }
   float getMotorRPM() const { return Motor.RPM; }
@@ -276,11 +788,27 @@ public:
   UniteDurumu getUniteDurumu() const { return Sistem.Durum; }
   UniteModu getUniteModu() const { return Sistem.Mod; }
   bool getBaglantiDurumu() const { return connectionStatus; }
+  uint8_t getSlaveID() const { return slaveID; }
+  uint32_t getBaudRate() const { return bus->getBaudRate(); }
+  uint32_t getRegisterHizi() const { return bus->getRegisterHizi(); }
+  uint32_t getCrcHatasi() const { return bus->getCrcHatasi(); }
+  uint32_t getZamanAsimiSayisi() const { return bus->getZamanAsimiSayisi(); }
+  
+  // Hız tespiti; paylaşılan hatta tüm ünitelerin hızını değiştirir
+  uint32_t negotiateBaud(bool zorla = false);
+  uint8_t getConsecutiveErrors() const { return consecutiveErrors; }
+  float getBaglantiSkoru() const { return baglantiSkoru; }
+  unsigned long getSonBasariliIslem() const { return sonBasariliIslem; }
+  unsigned long getLastUpdateTime() const { return lastUpdateTime; }
   
   // Ayar fonksiyonları
   void enableAutoUpdate(bool enable = true) { autoUpdate = enable; }
   void setUpdateInterval(unsigned long interval) { updateInterval = interval; }
+  void setPollPeriod(PollGrubu grup, unsigned long periyot, uint16_t faz = 0);
+  // Yük yüzdesinin paydası (kW); şebeke için bağlantı gücü verilebilir
+  void setNominalGuc(float jeneratorKw, float sebekeKw = 0.0f);
   void setSlaveID(uint8_t newSlaveID);
+  void onAlarmEvent(AlarmCallback callback) { alarmCallback = callback; }
 };
 
 #endif // D300_CONTROLLER_H
@@ -0,0 +1,195 @@
+/*
+ * D300JsonYazici.h
+ * D-300 MK3 Modbus RTU Library for ESP32
+ * Heap kullanmayan akışlı JSON yazıcı
+ *
+ * Çıktı çağıranın verdiği sabit tampona yazılır. Bir çıkış fonksiyonu
+ * verilirse tampon dolduğunda içerik ona aktarılır ve tampon yeniden
+ * kullanılır (ağa parça parça gönderim); verilmezse taşan kısım kesilir ve
+ * tasti() true döner. Virgüller iç içe nesne/dizi derinliğine göre otomatik
+ * konur. Ondalıklı sayılar printf kullanmadan, tamsayıya ölçeklenip
+ * D300Sabit::yaz() ile yazılır.
+ */
+
+#ifndef D300_JSON_YAZICI_H
+#define D300_JSON_YAZICI_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include "D300SabitNokta.h"
+
+class JsonYazici {
+public:
+  // Parça sonlandırıcılıdır; uzunluk sonlandırıcı hariçtir
+  typedef void (*Cikis)(void* baglam, const char* parca, size_t uzunluk);
+
+  static const uint8_t MAX_DERINLIK = 32;
+
+  JsonYazici(char* tampon, size_t boyut, Cikis cikis = nullptr, void* baglam = nullptr)
+    : tampon(tampon), boyut(boyut), doluluk(0), toplam(0), cikis(cikis), baglam(baglam),
+      derinlik(0), ilkOge(1), anahtarBekliyor(false), tasma(false) {
+    if (boyut > 0) tampon[0] = '\0';
+  }
+
+  // Yapı
+  JsonYazici& nesneBasla() { oge(); yaz('{'); ac(); return *this; }
+  JsonYazici& nesneBitir() { kapat(); yaz('}'); return *this; }
+  JsonYazici& diziBasla() { oge(); yaz('['); ac(); return *this; }
+  JsonYazici& diziBitir() { kapat(); yaz(']'); return *this; }
+  JsonYazici& nesneBasla(const char* ad) { return anahtar(ad).nesneBasla(); }
+  JsonYazici& diziBasla(const char* ad) { return anahtar(ad).diziBasla(); }
+
+  JsonYazici& anahtar(const char* ad) {
+    oge();
+    metinYaz(ad);
+    yaz(':');
+    anahtarBekliyor = true;
+    return *this;
+  }
+  JsonYazici& anahtar(uint32_t ad) {
+    // Sayısal anahtar (register adresi gibi) tırnak içinde
+    oge();
+    yaz('"');
+    tamsayiYaz(ad);
+    yaz('"');
+    yaz(':');
+    anahtarBekliyor = true;
+    return *this;
+  }
+
+  // Değerler
+  JsonYazici& deger(bool b) { oge(); yaz(b ? "true" : "false"); return *this; }
+  // Temel tiplerle; int32_t/uint32_t platforma göre int ya da long olabilir
+  JsonYazici& deger(int v) { oge(); tamsayiYaz(v); return *this; }
+  JsonYazici& deger(unsigned int v) { oge(); tamsayiYaz(v); return *this; }
+  JsonYazici& deger(long v) { oge(); tamsayiYaz(v); return *this; }
+  JsonYazici& deger(unsigned long v) { oge(); tamsayiYaz(v); return *this; }
+  JsonYazici& deger(long long v) { oge(); tamsayiYaz(v); return *this; }
+  JsonYazici& deger(const char* s) { oge(); metinYaz(s); return *this; }
+  JsonYazici& sabit(int64_t ham, uint8_t ondalik) { oge(); sabitYaz(ham, ondalik); return *this; }
+  template <uint8_t N, typename T>
+  JsonYazici& deger(SabitNokta<N, T> s) { return sabit(s.ham, N); }
+
+  // Float sabit basamakla yazılır; sonlu değilse null
+  JsonYazici& deger(float f, uint8_t ondalik) {
+    oge();
+    if (!isfinite(f)) {
+      yaz("null");
+    } else {
+      sabitYaz((int64_t)llroundf(f * (float)D300Sabit::us10(ondalik)), ondalik);
+    }
+    return *this;
+  }
+
+  // Önceden biçimlenmiş JSON parçası (sayı, iç içe belge)
+  JsonYazici& hamDeger(const char* s) { oge(); yaz(s); return *this; }
+
+  // Metni tırnaklar içinde, tırnak ve ters bölü kaçışlarıyla parça parça yazar
+  JsonYazici& metinBasla() { oge(); yaz('"'); return *this; }
+  JsonYazici& metinParca(const char* s) { kacisliYaz(s); return *this; }
+  JsonYazici& metinParca(uint32_t v) { tamsayiYaz(v); return *this; }
+  JsonYazici& metinBitir() { yaz('"'); return *this; }
+
+  template <typename V>
+  JsonYazici& alan(const char* ad, V v) { return anahtar(ad).deger(v); }
+  JsonYazici& alan(const char* ad, float f, uint8_t ondalik) { return anahtar(ad).deger(f, ondalik); }
+
+  // Kalan veriyi çıkışa aktarır; tampon modunda yazılan uzunluğu döner
+  size_t bitir() {
+    if (cikis != nullptr && doluluk > 0) bosalt();
+    return toplam;
+  }
+
+  size_t uzunluk() const { return toplam; }
+  bool tasti() const { return tasma; }
+  const char* c_str() const { return tampon; }
+
+private:
+  char* tampon;
+  size_t boyut;
+  size_t doluluk;                 // Tampondaki bayt
+  size_t toplam;                  // Şimdiye kadar üretilen bayt
+  Cikis cikis;
+  void* baglam;
+  uint8_t derinlik;
+  uint32_t ilkOge;                // Derinlik başına "henüz öğe yazılmadı" biti
+  bool anahtarBekliyor;
+  bool tasma;
+
+  void ac() {
+    if (derinlik + 1 < MAX_DERINLIK) derinlik++;
+    ilkOge |= (uint32_t)1 << derinlik;
+  }
+  void kapat() {
+    if (derinlik > 0) derinlik--;
+    anahtarBekliyor = false;
+  }
+
+  // Anahtardan sonra gelen değer virgül almaz; diğer öğeler ilk değilse alır
+  void oge() {
+    if (anahtarBekliyor) {
+      anahtarBekliyor = false;
+      return;
+    }
+    uint32_t bit = (uint32_t)1 << derinlik;
+    if (ilkOge & bit) {
+      ilkOge &= ~bit;
+    } else {
+      yaz(',');
+    }
+  }
+
+  void bosalt() {
+    tampon[doluluk] = '\0';
+    cikis(baglam, tampon, doluluk);
+    doluluk = 0;
+  }
+
+  void yaz(char c) {
+    if (boyut < 2) {
+      tasma = true;
+      return;
+    }
+    if (doluluk + 1 >= boyut) {
+      if (cikis == nullptr) {
+        tasma = true;
+        return;
+      }
+      bosalt();
+    }
+    tampon[doluluk++] = c;
+    tampon[doluluk] = '\0';
+    toplam++;
+  }
+  void yaz(const char* s) {
+    while (*s) yaz(*s++);
+  }
+
+  void kacisliYaz(const char* s) {
+    for (; *s; s++) {
+      if (*s == '"' || *s == '\\') {
+        yaz('\\');
+        yaz(*s);
+      } else if ((uint8_t)*s < 0x20) {
+        yaz(' ');                 // Kontrol karakterleri metinlerde beklenmez
+      } else {
+        yaz(*s);
+      }
+    }
+  }
+  void metinYaz(const char* s) {
+    yaz('"');
+    kacisliYaz(s);
+    yaz('"');
+  }
+
+  void sabitYaz(int64_t ham, uint8_t ondalik) {
+    char gecici[24];
+    D300Sabit::yaz(gecici, sizeof(gecici), ham, ondalik);
+    yaz(gecici);
+  }
+  void tamsayiYaz(int64_t v) { sabitYaz(v, 0); }
+};
+
+#endif // D300_JSON_YAZICI_H
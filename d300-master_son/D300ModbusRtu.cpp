@@ -0,0 +1,375 @@
+/*
+ * D300ModbusRtu.cpp
+ * D-300 MK3 Modbus RTU Library for ESP32
+ * Implementation File - Bloklamayan Modbus RTU durum makinesi
+ */
+
+#include "D300ModbusRtu.h"
+#include <Preferences.h>
+
+static const uint8_t FC_READ_HOLDING = 0x03;
+static const uint8_t FC_WRITE_SINGLE = 0x06;
+static const unsigned long VARSAYILAN_TIMEOUT_MS = 500;
+static const uint8_t ORNEK_SIFIRLAMA_ZAMAN_ASIMI = 3;   // Art arda bu kadar zaman aşımında yeniden öğren
+
+// Hız tespiti
+const uint32_t D300ModbusRtu::BAUD_HIZLARI[D300ModbusRtu::BAUD_SAYISI] = {115200, 57600, 38400, 19200, 9600};
+static const char* LINK_NVS_ALANI = "d300_link";
+static const uint8_t TESPIT_TEKRARI = 10;
+static const uint8_t DOGRULAMA_TEKRARI = 3;
+static const unsigned long TESPIT_TIMEOUT_MS = 100;    // Yanlış hızda cevap hiç gelmez
+
+D300ModbusRtu::D300ModbusRtu()
+  : port(nullptr), baud(9600), karakterUs(1146), t35Us(4010), timeoutMs(VARSAYILAN_TIMEOUT_MS),
+    ilkBaytTimeoutUs(VARSAYILAN_TIMEOUT_MS * 1000), durum(Durum::Bosta), sonSonuc(ModbusSonuc::Basarili),
+    cevapUzunluk(0), beklenenUzunluk(0), hedef(nullptr), hedefAdet(0), callback(nullptr), baglam(nullptr),
+    gonderimUs(0), ilkBaytUs(0), sonBaytUs(0), ornekIndeks(0), ornekAdet(0), donusP95Us(0),
+    p95Guncel(false), ardisikZamanAsimi(0), okunanRegister(0), crcHatasi(0), zamanAsimiSayisi(0),
+    registerHizi(0), hizPencereBaslangic(0), hizPencereRegister(0) {
+}
+
+void D300ModbusRtu::begin(HardwareSerial& port, uint32_t baudRate) {
+  this->port = &port;
+  this->baud = baudRate;
+  
+  // UART baytları FIFO dolmasını beklemeden teslim etsin; aksi halde ilk bayt
+  // zamanı (dönüş süresi ölçümü) çerçeve boyuna göre kayar
+  port.setRxFIFOFull(1);
+
+  // 3.5 karakter (11 bit) sessizlik; 19200 üzerinde standart sabit 1750 us
+  karakterUs = baudRate ? (11000000UL + baudRate - 1) / baudRate : 1146;
+  t35Us = (baudRate > 19200 || baudRate == 0) ? 1750 : 38500000UL / baudRate;
+  
+  // Baud değişince dönüş süresi yeniden öğrenilir
+  ornekAdet = 0;
+  ornekIndeks = 0;
+  p95Guncel = false;
+
+  durum = Durum::Bosta;
+  sonBaytUs = micros();
+}
+
+bool D300ModbusRtu::startReadHoldingRegisters(uint8_t slaveID, uint16_t adres, uint16_t adet, uint16_t* tampon,
+                                              Callback callback, void* baglam) {
+  if (adet == 0 || adet > MAX_REGISTER || tampon == nullptr) return false;
+  if (!startRequest(slaveID, FC_READ_HOLDING, adres, adet, 5 + 2 * adet, callback, baglam)) return false;
+  hedef = tampon;
+  hedefAdet = adet;
+  poll();   // Hat sessizse istek hemen gönderilir
+  return true;
+}
+
+bool D300ModbusRtu::startWriteSingleRegister(uint8_t slaveID, uint16_t adres, uint16_t deger,
+                                             Callback callback, void* baglam) {
+  if (!startRequest(slaveID, FC_WRITE_SINGLE, adres, deger, 8, callback, baglam)) return false;
+  hedef = nullptr;
+  hedefAdet = 0;
+  poll();
+  return true;
+}
+
+bool D300ModbusRtu::startRequest(uint8_t slaveID, uint8_t fonksiyon, uint16_t adres, uint16_t deger,
+                                 uint16_t beklenen, Callback callback, void* baglam) {
+  if (port == nullptr || isBusy()) return false;
+
+  istek[0] = slaveID;
+  istek[1] = fonksiyon;
+  istek[2] = adres >> 8;
+  istek[3] = adres & 0xFF;
+  istek[4] = deger >> 8;
+  istek[5] = deger & 0xFF;
+  uint16_t crc = crc16(istek, 6);
+  istek[6] = crc & 0xFF;
+  istek[7] = crc >> 8;
+
+  beklenenUzunluk = beklenen;
+  this->callback = callback;
+  this->baglam = baglam;
+  durum = Durum::GonderimBekliyor;
+  return true;
+}
+
+void D300ModbusRtu::sendRequest() {
+  ilkBaytTimeoutUs = getFirstByteTimeoutUs();
+  port->write(istek, sizeof(istek));
+  gonderimUs = micros();
+  sonBaytUs = gonderimUs + karakterUs * sizeof(istek);
+  cevapUzunluk = 0;
+  durum = Durum::CevapBekleniyor;
+}
+
+void D300ModbusRtu::recordTurnaround(uint32_t us) {
+  donusOrnekleri[ornekIndeks] = us;
+  ornekIndeks = (ornekIndeks + 1) % DONUS_ORNEK_SAYISI;
+  if (ornekAdet < DONUS_ORNEK_SAYISI) ornekAdet++;
+  p95Guncel = false;
+}
+
+uint32_t D300ModbusRtu::getTurnaroundP95Us() {
+  if (p95Guncel || ornekAdet == 0) return donusP95Us;
+  
+  // En fazla 32 örnek: kopyala ve insertion sort
+  uint32_t sirali[DONUS_ORNEK_SAYISI];
+  for (uint8_t i = 0; i < ornekAdet; i++) {
+    uint32_t x = donusOrnekleri[i];
+    uint8_t j = i;
+    while (j > 0 && sirali[j - 1] > x) {
+      sirali[j] = sirali[j - 1];
+      j--;
+    }
+    sirali[j] = x;
+  }
+  donusP95Us = sirali[(ornekAdet * 95 + 99) / 100 - 1];
+  p95Guncel = true;
+  return donusP95Us;
+}
+
+uint32_t D300ModbusRtu::getFirstByteTimeoutUs() {
+  uint32_t ustSinir = timeoutMs * 1000;
+  if (ornekAdet < MIN_DONUS_ORNEGI) return ustSinir;
+  
+  // İstek iletimi + dönüş süresi + pay (dönüşün yarısı, en az birkaç ms)
+  uint32_t donus = getTurnaroundP95Us();
+  uint32_t pay = donus / 2 > TIMEOUT_PAYI_US ? donus / 2 : TIMEOUT_PAYI_US;
+  uint32_t timeout = karakterUs * sizeof(istek) + donus + pay;
+  return timeout < ustSinir ? timeout : ustSinir;
+}
+
+void D300ModbusRtu::poll() {
+  switch (durum) {
+    case Durum::Bosta:
+      return;
+
+    case Durum::GonderimBekliyor:
+      // Önceki işlemden kalan baytlar atılır, hat T3.5 boyunca sessiz olmalı
+      while (port->available() > 0) {
+        port->read();
+        sonBaytUs = micros();
+      }
+      if ((uint32_t)(micros() - sonBaytUs) >= t35Us) {
+        sendRequest();
+      }
+      return;
+
+    case Durum::CevapBekleniyor:
+      while (port->available() > 0) {
+        uint8_t bayt = port->read();
+        sonBaytUs = micros();
+        if (cevapUzunluk == 0) {
+          ilkBaytUs = sonBaytUs;
+        }
+        if (cevapUzunluk < sizeof(cevap)) {
+          cevap[cevapUzunluk++] = bayt;
+        }
+
+        // İstisna cevabı 5 bayttır
+        if (cevapUzunluk == 2 && (cevap[1] & 0x80)) {
+          beklenenUzunluk = 5;
+        }
+        if (cevapUzunluk >= beklenenUzunluk) {
+          finish(parseResponse());
+          return;
+        }
+      }
+
+      {
+        uint32_t simdi = micros();
+        bool zamanAsimi;
+        if (cevapUzunluk == 0) {
+          zamanAsimi = (uint32_t)(simdi - gonderimUs) >= ilkBaytTimeoutUs;
+        } else {
+          // Çerçevenin kalanı iletim süresi + pay içinde tamamlanmalı
+          zamanAsimi = (uint32_t)(simdi - ilkBaytUs) >= karakterUs * beklenenUzunluk + TIMEOUT_PAYI_US ||
+                       (uint32_t)(simdi - gonderimUs) >= timeoutMs * 1000;
+        }
+        if (zamanAsimi) {
+          finish(cevapUzunluk > 0 ? ModbusSonuc::GecersizCevap : ModbusSonuc::ZamanAsimi);
+        }
+      }
+      return;
+  }
+}
+
+ModbusSonuc D300ModbusRtu::parseResponse() {
+  uint16_t crc = crc16(cevap, cevapUzunluk - 2);
+  if (cevap[cevapUzunluk - 2] != (crc & 0xFF) || cevap[cevapUzunluk - 1] != (crc >> 8)) {
+    return ModbusSonuc::GecersizCRC;
+  }
+  if (cevap[0] != istek[0]) {
+    return ModbusSonuc::GecersizSlave;
+  }
+  if ((cevap[1] & 0x7F) != istek[1]) {
+    return ModbusSonuc::GecersizCevap;
+  }
+  if (cevap[1] & 0x80) {
+    return static_cast<ModbusSonuc>(cevap[2]);
+  }
+
+  if (istek[1] == FC_READ_HOLDING) {
+    if (cevap[2] != hedefAdet * 2) {
+      return ModbusSonuc::GecersizCevap;
+    }
+    // Hedef tampon sadece geçerli cevapta yazılır
+    for (uint16_t i = 0; i < hedefAdet; i++) {
+      hedef[i] = ((uint16_t)cevap[3 + 2 * i] << 8) | cevap[4 + 2 * i];
+    }
+  } else if (memcmp(cevap, istek, 6) != 0) {
+    // FC06 cevabı isteğin aynısıdır
+    return ModbusSonuc::GecersizCevap;
+  }
+  return ModbusSonuc::Basarili;
+}
+
+void D300ModbusRtu::finish(ModbusSonuc sonuc) {
+  Callback cb = callback;
+  void* cbBaglam = baglam;
+  
+  // İstatistikler: okunan register/sn 1 saniyelik pencerelerle
+  if (sonuc == ModbusSonuc::Basarili) {
+    okunanRegister += hedefAdet;
+    hizPencereRegister += hedefAdet;
+  } else if (sonuc == ModbusSonuc::GecersizCRC) {
+    crcHatasi++;
+  } else if (sonuc == ModbusSonuc::ZamanAsimi) {
+    zamanAsimiSayisi++;
+  }
+  uint32_t simdiMs = millis();
+  if (simdiMs - hizPencereBaslangic >= 1000) {
+    registerHizi = hizPencereBaslangic ? hizPencereRegister * 1000UL / (simdiMs - hizPencereBaslangic) : 0;
+    hizPencereBaslangic = simdiMs;
+    hizPencereRegister = 0;
+  }
+  
+  if (cevapUzunluk > 0) {
+    // Cevap geldiyse (CRC hatalı olsa bile) slave'in dönüş süresi ölçülmüştür
+    uint32_t istekSonu = gonderimUs + karakterUs * sizeof(istek);
+    recordTurnaround((int32_t)(ilkBaytUs - istekSonu) > 0 ? ilkBaytUs - istekSonu : 0);
+    ardisikZamanAsimi = 0;
+  } else if (++ardisikZamanAsimi >= ORNEK_SIFIRLAMA_ZAMAN_ASIMI) {
+    // Slave yavaşlamış olabilir: örnekler atılır, üst sınırla yeniden öğrenilir
+    ornekAdet = 0;
+    ornekIndeks = 0;
+    ardisikZamanAsimi = 0;
+  }
+
+  // Callback içinden yeni işlem başlatılabilsin diye önce boşa çıkılır
+  sonSonuc = sonuc;
+  durum = Durum::Bosta;
+  callback = nullptr;
+  baglam = nullptr;
+
+  if (cb) {
+    cb(cbBaglam, sonuc);
+  }
+}
+
+ModbusSonuc D300ModbusRtu::waitForCompletion() {
+  while (isBusy()) {
+    poll();
+    yield();
+  }
+  return sonSonuc;
+}
+
+ModbusSonuc D300ModbusRtu::readHoldingRegisters(uint8_t slaveID, uint16_t adres, uint16_t adet, uint16_t* tampon) {
+  waitForCompletion();
+  if (!startReadHoldingRegisters(slaveID, adres, adet, tampon)) {
+    return ModbusSonuc::GecersizDeger;
+  }
+  return waitForCompletion();
+}
+
+ModbusSonuc D300ModbusRtu::writeSingleRegister(uint8_t slaveID, uint16_t adres, uint16_t deger) {
+  waitForCompletion();
+  if (!startWriteSingleRegister(slaveID, adres, deger)) {
+    return ModbusSonuc::GecersizDeger;
+  }
+  return waitForCompletion();
+}
+
+void D300ModbusRtu::setBaudRate(uint32_t baudRate) {
+  waitForCompletion();
+  port->updateBaudRate(baudRate);
+  begin(*port, baudRate);
+}
+
+LinkOlcumu D300ModbusRtu::measureLink(uint8_t slaveID, uint16_t adres, uint16_t adet, uint8_t tekrar) {
+  static uint16_t tampon[MAX_REGISTER];
+  LinkOlcumu olcum;
+  olcum.baud = baud;
+  
+  unsigned long oncekiTimeout = timeoutMs;
+  timeoutMs = TESPIT_TIMEOUT_MS;
+  uint32_t baslangic = micros();
+  uint32_t register_ = 0;
+  
+  for (uint8_t i = 0; i < tekrar; i++) {
+    ModbusSonuc sonuc = readHoldingRegisters(slaveID, adres, adet, tampon);
+    olcum.deneme++;
+    if (sonuc == ModbusSonuc::Basarili) {
+      olcum.basarili++;
+      register_ += adet;
+    } else if (sonuc == ModbusSonuc::GecersizCRC) {
+      olcum.crcHatasi++;
+    } else if (sonuc == ModbusSonuc::ZamanAsimi) {
+      olcum.zamanAsimi++;
+      // İlk iki istek de cevapsızsa bu hızda slave yok
+      if (olcum.basarili == 0 && olcum.zamanAsimi >= 2) break;
+    }
+  }
+  
+  uint32_t gecen = micros() - baslangic;
+  olcum.registerHizi = gecen ? (uint32_t)((uint64_t)register_ * 1000000ULL / gecen) : 0;
+  timeoutMs = oncekiTimeout;
+  return olcum;
+}
+
+uint32_t D300ModbusRtu::negotiateBaud(uint8_t slaveID, uint16_t adres, uint16_t adet, bool zorla) {
+  char anahtar[12];
+  snprintf(anahtar, sizeof(anahtar), "baud_%u", slaveID);
+  
+  Preferences nvs;
+  nvs.begin(LINK_NVS_ALANI, false);
+  uint32_t kayitli = zorla ? 0 : nvs.getUInt(anahtar, 0);
+  
+  // Kayıtlı hız hâlâ çalışıyorsa tarama yapılmaz
+  if (kayitli) {
+    setBaudRate(kayitli);
+    LinkOlcumu olcum = measureLink(slaveID, adres, adet, DOGRULAMA_TEKRARI);
+    if (olcum.basarili == olcum.deneme) {
+      nvs.end();
+      return kayitli;
+    }
+  }
+  
+  uint32_t secilen = 0;
+  for (uint8_t i = 0; i < BAUD_SAYISI; i++) {
+    setBaudRate(BAUD_HIZLARI[i]);
+    linkOlcumleri[i] = measureLink(slaveID, adres, adet, TESPIT_TEKRARI);
+    
+    // Hatasız ilk (en hızlı) hız seçilir
+    if (linkOlcumleri[i].basarili == linkOlcumleri[i].deneme) {
+      secilen = BAUD_HIZLARI[i];
+      break;
+    }
+  }
+  
+  if (secilen) {
+    nvs.putUInt(anahtar, secilen);
+  } else {
+    setBaudRate(kayitli ? kayitli : 9600);
+  }
+  nvs.end();
+  return secilen;
+}
+
+uint16_t D300ModbusRtu::crc16(const uint8_t* veri, uint16_t uzunluk) {
+  uint16_t crc = 0xFFFF;
+  for (uint16_t i = 0; i < uzunluk; i++) {
+    crc ^= veri[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    }
+  }
+  return crc;
+}
@@ -0,0 +1,175 @@
+/*
+ * D300ModbusRtu.h
+ * D-300 MK3 Modbus RTU Library for ESP32
+ * Bloklamayan Modbus RTU master - FC03 / FC06
+ *
+ * İstek gönderildikten sonra fonksiyon hemen döner; poll() her çağrıldığında
+ * UART'tan gelen baytları toplar, çerçeve tamamlanınca CRC'yi kontrol eder ve
+ * tamamlanma callback'ini çağırır. Bloklayan yardımcılar aynı durum makinesini
+ * kullanır.
+ *
+ * Zaman aşımı iki aşamalıdır: ilk cevap baytı, ölçülen dönüş süresinin (son 32
+ * örneğin %95'liği) biraz fazlası içinde gelmelidir; gelirse çerçevenin geri
+ * kalanı baud'a göre iletim süresi kadar beklenir. setTimeout() üst sınırdır.
+ *
+ * D-300'ün baud'u cihazın kendi menüsünden ayarlanır; Modbus üzerinden
+ * değiştirilemez. negotiateBaud() bu yüzden hızı pazarlık etmez, desteklenen
+ * hızları hızlıdan yavaşa deneyerek cihazın ayarlı olduğu hızı bulur.
+ */
+
+#ifndef D300_MODBUS_RTU_H
+#define D300_MODBUS_RTU_H
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+#include <HardwareSerial.h>
+
+// İşlem sonuçları - değerler ModbusMaster ile aynı
+enum class ModbusSonuc : uint8_t {
+  Basarili = 0x00,
+  GecersizFonksiyon = 0x01,     // Modbus istisna kodları
+  GecersizAdres = 0x02,
+  GecersizDeger = 0x03,
+  CihazHatasi = 0x04,
+  GecersizSlave = 0xE0,
+  GecersizCevap = 0xE1,
+  ZamanAsimi = 0xE2,
+  GecersizCRC = 0xE3,
+  Iptal = 0xFD,                 // Komut kuyrukta beklerken iptal edildi
+  Mesgul = 0xFE
+};
+
+// Hat kilidi - edinim görevi ve loop() aynı anda kuyruğa/hatta dokunmaz.
+// Kilit özyinelemelidir; updateData() -> updateBasicData() gibi iç çağrılar tekrar alabilir.
+struct BusKilidi {
+  SemaphoreHandle_t kilit;
+  explicit BusKilidi(SemaphoreHandle_t kilit) : kilit(kilit) {
+    if (kilit) xSemaphoreTakeRecursive(kilit, portMAX_DELAY);
+  }
+  ~BusKilidi() {
+    if (kilit) xSemaphoreGiveRecursive(kilit);
+  }
+};
+
+// Bir baud hızında yapılan okuma denemesinin sonucu
+struct LinkOlcumu {
+  uint32_t baud = 0;
+  uint8_t deneme = 0;
+  uint8_t basarili = 0;
+  uint8_t crcHatasi = 0;
+  uint8_t zamanAsimi = 0;
+  uint32_t registerHizi = 0;     // register/sn
+};
+
+class D300ModbusRtu {
+public:
+  typedef void (*Callback)(void* baglam, ModbusSonuc sonuc);
+
+  static const uint16_t MAX_REGISTER = 125;   // FC03 tek istekte en fazla 125 register
+  static const uint8_t DONUS_ORNEK_SAYISI = 32;
+  static const uint8_t MIN_DONUS_ORNEGI = 8;    // Daha azıyla üst sınır kullanılır
+  static const uint32_t TIMEOUT_PAYI_US = 3000;
+  
+  // D-300'ün desteklediği hızlar, hızlıdan yavaşa
+  static const uint8_t BAUD_SAYISI = 5;
+  static const uint32_t BAUD_HIZLARI[BAUD_SAYISI];
+
+  D300ModbusRtu();
+  void begin(HardwareSerial& port, uint32_t baudRate);
+
+  // Asenkron işlemler - hat meşgulse false döner, sonuç callback ile gelir
+  bool startReadHoldingRegisters(uint8_t slaveID, uint16_t adres, uint16_t adet, uint16_t* tampon,
+                                 Callback callback = nullptr, void* baglam = nullptr);
+  bool startWriteSingleRegister(uint8_t slaveID, uint16_t adres, uint16_t deger,
+                                Callback callback = nullptr, void* baglam = nullptr);
+  void poll();
+  bool isBusy() const { return durum != Durum::Bosta; }
+
+  // Bloklayan yardımcılar - önce devam eden işlemin bitmesini bekler
+  ModbusSonuc readHoldingRegisters(uint8_t slaveID, uint16_t adres, uint16_t adet, uint16_t* tampon);
+  ModbusSonuc writeSingleRegister(uint8_t slaveID, uint16_t adres, uint16_t deger);
+  ModbusSonuc waitForCompletion();
+
+  // Hız tespiti: her hızda 'tekrar' blok okuması yapılır, hatasız en hızlı seçilir.
+  // Seçilen hız NVS'e kaydedilir; sonraki açılışta önce o hız doğrulanır.
+  void setBaudRate(uint32_t baudRate);
+  uint32_t getBaudRate() const { return baud; }
+  LinkOlcumu measureLink(uint8_t slaveID, uint16_t adres, uint16_t adet, uint8_t tekrar);
+  uint32_t negotiateBaud(uint8_t slaveID, uint16_t adres, uint16_t adet, bool zorla = false);
+  const LinkOlcumu& getLinkOlcumu(uint8_t i) const { return linkOlcumleri[i]; }
+  
+  // Hat istatistikleri
+  uint32_t getRegisterHizi() const { return registerHizi; }
+  uint32_t getOkunanRegister() const { return okunanRegister; }
+  uint32_t getCrcHatasi() const { return crcHatasi; }
+  uint32_t getZamanAsimiSayisi() const { return zamanAsimiSayisi; }
+  
+  ModbusSonuc getSonSonuc() const { return sonSonuc; }
+  uint32_t getTurnaroundP95Us();
+  uint32_t getT35Us() const { return t35Us; }
+  uint32_t getGonderimUs() const { return gonderimUs; }   // Son isteğin hatta çıktığı an (micros)
+  uint32_t getFirstByteTimeoutUs();
+  static uint16_t crc16(const uint8_t* veri, uint16_t uzunluk);   // CRC-16/MODBUS
+  static bool isIstisna(ModbusSonuc sonuc) { return (uint8_t)sonuc > 0 && (uint8_t)sonuc < 0xE0; }
+  void setTimeout(unsigned long ms) { timeoutMs = ms; }
+  unsigned long getTimeout() const { return timeoutMs; }
+
+private:
+  enum class Durum : uint8_t {
+    Bosta,
+    GonderimBekliyor,   // Çerçeveler arası sessizlik bekleniyor
+    CevapBekleniyor
+  };
+
+  HardwareSerial* port;
+  uint32_t baud;
+  uint32_t karakterUs;            // Bir karakterin (11 bit) iletim süresi
+  uint32_t t35Us;                 // 3.5 karakter sessizlik süresi
+  unsigned long timeoutMs;        // Üst sınır
+  uint32_t ilkBaytTimeoutUs;      // Gönderilen isteğin ilk bayt zaman aşımı
+  Durum durum;
+  ModbusSonuc sonSonuc;
+
+  uint8_t istek[8];
+  uint8_t cevap[5 + 2 * MAX_REGISTER];
+  uint16_t cevapUzunluk;
+  uint16_t beklenenUzunluk;
+  uint16_t* hedef;
+  uint16_t hedefAdet;
+
+  Callback callback;
+  void* baglam;
+
+  uint32_t gonderimUs;
+  uint32_t ilkBaytUs;
+  uint32_t sonBaytUs;             // Son gönderilen/alınan bayt zamanı
+  
+  // Dönüş süresi örnekleri (istek sonu -> ilk cevap baytı)
+  uint32_t donusOrnekleri[DONUS_ORNEK_SAYISI];
+  uint8_t ornekIndeks;
+  uint8_t ornekAdet;
+  uint32_t donusP95Us;
+  bool p95Guncel;
+  uint8_t ardisikZamanAsimi;
+  
+  void recordTurnaround(uint32_t us);
+  
+  // İstatistikler ve hız tespiti sonuçları
+  uint32_t okunanRegister;
+  uint32_t crcHatasi;
+  uint32_t zamanAsimiSayisi;
+  uint32_t registerHizi;
+  uint32_t hizPencereBaslangic;    // ms
+  uint32_t hizPencereRegister;
+  LinkOlcumu linkOlcumleri[BAUD_SAYISI];
+
+  bool startRequest(uint8_t slaveID, uint8_t fonksiyon, uint16_t adres, uint16_t deger,
+                    uint16_t beklenen, Callback callback, void* baglam);
+  void sendRequest();
+  ModbusSonuc parseResponse();
+  void finish(ModbusSonuc sonuc);
+};
+
+#endif // D300_MODBUS_RTU_H
@@ -0,0 +1,452 @@
+/*
+ * D300RegisterMap.h
+ * D-300 MK3 Modbus RTU Library for ESP32
+ * Register haritası - adres, genişlik, katsayı, işaret ve hedef alan tek tabloda
+ *
+ * Her register bir Register<...> tipidir; gruplar (RegisterGrubu) derleme
+ * zamanında blok okuma planını ve çözme döngüsünü üretir. Yeni bir register
+ * eklendiğinde plan static_assert'lerle kontrol edilir.
+ *
+ * Not: C++17 gerektirir (arduino-esp32 3.x varsayılanı).
+ */
+
+#ifndef D300_REGISTER_MAP_H
+#define D300_REGISTER_MAP_H
+
+#include <string.h>
+#include <type_traits>
+#include "D300Controller.h"
+#include "D300BlokPlani.h"
+#include "D300SabitNokta.h"
+
+#if __cplusplus < 201703L
+#error "D300RegisterMap.h C++17 gerektirir"
+#endif
+
+namespace D300Map {
+
+// Tek register tanımı. Yol, D300Veri kökünden hedef alana giden üye işaretçileridir.
+template <uint16_t Adres, uint8_t Genislik, uint16_t Katsayi, bool Isaretli, auto... Yol>
+struct Register {
+  static_assert(Genislik == 1 || Genislik == 2, "Register genişliği 1 veya 2 olmalı");
+  static_assert(Katsayi > 0, "Katsayı sıfır olamaz");
+
+  static constexpr uint16_t adres = Adres;
+  static constexpr uint8_t genislik = Genislik;
+  static constexpr uint16_t katsayi = Katsayi;
+  static constexpr bool isaretli = Isaretli;
+  static constexpr bool kayan = false;
+
+  // Sabit noktalı gösterim: katsayı 10'un kuvveti olduğu için basamak tipte tutulur
+  static constexpr int8_t ondalik = D300Sabit::basamak(Katsayi);
+  using SabitTip = SabitNokta<(ondalik < 0 ? 0 : ondalik),
+                              typename std::conditional<Genislik == 2 && !Isaretli, int64_t, int32_t>::type>;
+
+  static constexpr SabitTip sabit(const uint16_t* reg) {
+    static_assert(ondalik >= 0, "Katsayı 10'un kuvveti değil, sabit nokta kullanılamaz");
+    uint32_t ham = (Genislik == 2) ? (((uint32_t)reg[0] << 16) | reg[1]) : reg[0];
+    if constexpr (Isaretli) {
+      return SabitTip::hamdan((Genislik == 2) ? (int32_t)ham : (int16_t)ham);
+    } else {
+      return SabitTip::hamdan(ham);
+    }
+  }
+
+  template <typename Kok>
+  static auto& alan(Kok& kok) { return (kok .* ... .* Yol); }
+
+  // Ham register değer(ler)ini hedef alanın tipine göre çözer
+  static void coz(D300Veri& veri, const uint16_t* reg) {
+    uint32_t ham = (Genislik == 2) ? (((uint32_t)reg[0] << 16) | reg[1]) : reg[0];
+    auto& hedef = alan(veri);
+    using Tip = typename std::remove_reference<decltype(hedef)>::type;
+
+    if constexpr (std::is_floating_point<Tip>::value) {
+      if constexpr (Isaretli) {
+        int32_t deger = (Genislik == 2) ? (int32_t)ham : (int16_t)ham;
+        hedef = (Tip)deger / Katsayi;
+      } else {
+        hedef = (Tip)ham / Katsayi;
+      }
+    } else {
+      static_assert(Katsayi == 1, "Tamsayı/enum alanlar ölçeklenemez");
+      hedef = static_cast<Tip>(ham);
+    }
+  }
+};
+
+// IEEE-754 float olarak saklanan 32 bit register (GPS koordinatları)
+template <uint16_t Adres, auto... Yol>
+struct FloatRegister {
+  static constexpr uint16_t adres = Adres;
+  static constexpr uint8_t genislik = 2;
+  static constexpr uint16_t katsayi = 1;
+  static constexpr bool isaretli = false;
+  static constexpr bool kayan = true;
+
+  static void coz(D300Veri& veri, const uint16_t* reg) {
+    uint32_t ham = ((uint32_t)reg[0] << 16) | reg[1];
+    float deger;
+    memcpy(&deger, &ham, sizeof(deger));
+    (veri .* ... .* Yol) = deger;
+  }
+};
+
+// Adrese göre register tipini bulur; yoksa void
+template <uint16_t Adres, typename... Regs>
+struct AdresliRegister {
+  using Tip = void;
+};
+
+template <uint16_t Adres, typename R, typename... Kalan>
+struct AdresliRegister<Adres, R, Kalan...> {
+  using Tip = typename std::conditional<R::adres == Adres, R,
+                                        typename AdresliRegister<Adres, Kalan...>::Tip>::type;
+};
+
+// Derleme zamanında sıralanan aralık listesi
+template <uint8_t N>
+struct AralikListesi {
+  RegisterAraligi a[N] = {};
+};
+
+// Değişim algılama ve çıktılar için alanın ölçek bilgisi
+struct AlanTanimi {
+  uint16_t adres = 0;
+  uint8_t genislik = 0;
+  uint16_t katsayi = 1;
+  bool isaretli = false;
+  bool kayan = false;     // IEEE-754 float (FloatRegister)
+};
+
+template <uint8_t N>
+struct TanimListesi {
+  AlanTanimi a[N] = {};
+};
+
+// Adrese göre sıralama - AralikListesi ve TanimListesi için
+template <typename Liste>
+constexpr Liste sirala(Liste s) {
+  const uint8_t N = sizeof(s.a) / sizeof(s.a[0]);
+  for (uint8_t i = 1; i < N; i++) {
+    auto x = s.a[i];
+    uint8_t j = i;
+    while (j > 0 && s.a[j - 1].adres > x.adres) {
+      s.a[j] = s.a[j - 1];
+      j--;
+    }
+    s.a[j] = x;
+  }
+  return s;
+}
+
+template <uint8_t N>
+constexpr bool cakismaYok(const AralikListesi<N>& s) {
+  for (uint8_t i = 1; i < N; i++) {
+    if (s.a[i - 1].adres + s.a[i - 1].genislik > s.a[i].adres) return false;
+  }
+  return true;
+}
+
+// Register grubu: derleme zamanında sıralanmış aralıklar, blok planı ve çözme döngüsü
+template <typename... Regs>
+struct RegisterGrubu {
+  static_assert(sizeof...(Regs) > 0, "Boş register grubu");
+  static constexpr uint8_t alanSayisi = sizeof...(Regs);
+
+  static constexpr AralikListesi<alanSayisi> sirali =
+    sirala(AralikListesi<alanSayisi>{{{Regs::adres, Regs::genislik}...}});
+  static constexpr BlokPlani plan = planla(sirali.a, alanSayisi);
+  static constexpr TanimListesi<alanSayisi> tanimlar =
+    sirala(TanimListesi<alanSayisi>{{{Regs::adres, Regs::genislik, Regs::katsayi, Regs::isaretli, Regs::kayan}...}});
+
+  template <uint16_t Adres>
+  using Bul = typename AdresliRegister<Adres, Regs...>::Tip;
+
+  static_assert(!plan.tasti, "Register grubu MAX_PLAN_BLOK bloğa sığmıyor");
+  static_assert(cakismaYok(sirali), "Register grubunda çakışan adresler var");
+
+  // Çalışma zamanı planı: 'destekli' false dönen alanlar plandan çıkarılır,
+  // 'boslukOkunur' false dönen boşluklar (çıkarılan alanı ya da okunamayan
+  // adresleri içeren) blok sınırı olur ve hiç okunmaz
+  template <typename Filtre, typename BoslukFiltresi>
+  static BlokPlani planlaFiltreli(Filtre destekli, BoslukFiltresi boslukOkunur) {
+    RegisterAraligi araliklar[alanSayisi];
+    uint8_t adet = 0;
+    for (uint8_t i = 0; i < alanSayisi; i++) {
+      if (destekli(sirali.a[i].adres)) {
+        araliklar[adet++] = sirali.a[i];
+      }
+    }
+    return planla(araliklar, adet, boslukOkunur);
+  }
+
+  // Ham register görüntüsünden tüm alanları çözer; ofsetler derleme zamanında
+  // bulunur, görüntüye hiç okunmamış alanlar varsayılan (0) değerini alır
+  template <const auto& Duzen>
+  static void cozGoruntu(D300Veri& veri, const uint16_t* ham) {
+    (cozGoruntuAlan<Regs, Duzen>(veri, ham), ...);
+  }
+
+private:
+  template <typename R, const auto& Duzen>
+  static void cozGoruntuAlan(D300Veri& veri, const uint16_t* ham) {
+    constexpr int16_t ofset = Duzen.ofsetBul(R::adres, R::genislik);
+    static_assert(ofset >= 0, "Register ham görüntünün dışında kaldı");
+    R::coz(veri, ham + ofset);
+  }
+};
+
+// Birden fazla grubu tek plan altında birleştirir
+template <typename... Gruplar> struct Birlestir;
+
+template <typename... A>
+struct Birlestir<RegisterGrubu<A...>> {
+  using Tip = RegisterGrubu<A...>;
+};
+
+template <typename... A, typename... B, typename... Kalan>
+struct Birlestir<RegisterGrubu<A...>, RegisterGrubu<B...>, Kalan...> {
+  using Tip = typename Birlestir<RegisterGrubu<A..., B...>, Kalan...>::Tip;
+};
+
+// Kök kısayolları
+template <uint16_t A, uint8_t G, uint16_t K, bool S, auto... Yol>
+using Sebeke = Register<A, G, K, S, &D300Veri::ElektrikSistemi, &ElektrikSistemiVerisi::Sebeke, Yol...>;
+
+template <uint16_t A, uint8_t G, uint16_t K, bool S, auto... Yol>
+using Jenerator = Register<A, G, K, S, &D300Veri::ElektrikSistemi, &ElektrikSistemiVerisi::Jenerator, Yol...>;
+
+template <uint16_t A, uint8_t G, uint16_t K, bool S, auto... Yol>
+using Motor = Register<A, G, K, S, &D300Veri::Motor, Yol...>;
+
+template <uint16_t A, uint8_t G, uint16_t K, bool S, auto... Yol>
+using Sistem = Register<A, G, K, S, &D300Veri::Sistem, Yol...>;
+
+template <uint16_t A, uint8_t G, uint16_t K, bool S, auto... Yol>
+using Sayac = Register<A, G, K, S, &D300Veri::Sayac, Yol...>;
+
+template <uint16_t A, uint8_t G, uint16_t K, bool S, auto... Yol>
+using Analog = Register<A, G, K, S, &D300Veri::AnalogGiris, Yol...>;
+
+// ---------------------------------------------------------------------------
+// Register tablosu (adres, genişlik, katsayı, işaretli, hedef alan)
+// ---------------------------------------------------------------------------
+
+using ElektrikRegisterlari = RegisterGrubu<
+  // Faz-nötr voltajları
+  Sebeke<10240, 2, 10, false, &ElektrikselSistem::L1, &FazVerisi::Voltaj>,
+  Sebeke<10242, 2, 10, false, &ElektrikselSistem::L2, &FazVerisi::Voltaj>,
+  Sebeke<10244, 2, 10, false, &ElektrikselSistem::L3, &FazVerisi::Voltaj>,
+  Jenerator<10246, 2, 10, false, &ElektrikselSistem::L1, &FazVerisi::Voltaj>,
+  Jenerator<10248, 2, 10, false, &ElektrikselSistem::L2, &FazVerisi::Voltaj>,
+  Jenerator<10250, 2, 10, false, &ElektrikselSistem::L3, &FazVerisi::Voltaj>,
+  // Faz-faz voltajları
+  Sebeke<10252, 2, 10, false, &ElektrikselSistem::FazVoltajL1L2>,
+  Sebeke<10254, 2, 10, false, &ElektrikselSistem::FazVoltajL2L3>,
+  Sebeke<10256, 2, 10, false, &ElektrikselSistem::FazVoltajL3L1>,
+  Jenerator<10258, 2, 10, false, &ElektrikselSistem::FazVoltajL1L2>,
+  Jenerator<10260, 2, 10, false, &ElektrikselSistem::FazVoltajL2L3>,
+  Jenerator<10262, 2, 10, false, &ElektrikselSistem::FazVoltajL3L1>,
+  // Akımlar
+  Sebeke<10264, 2, 10, false, &ElektrikselSistem::L1, &FazVerisi::Akim>,
+  Sebeke<10266, 2, 10, false, &ElektrikselSistem::L2, &FazVerisi::Akim>,
+  Sebeke<10268, 2, 10, false, &ElektrikselSistem::L3, &FazVerisi::Akim>,
+  Jenerator<10270, 2, 10, false, &ElektrikselSistem::L1, &FazVerisi::Akim>,
+  Jenerator<10272, 2, 10, false, &ElektrikselSistem::L2, &FazVerisi::Akim>,
+  Jenerator<10274, 2, 10, false, &ElektrikselSistem::L3, &FazVerisi::Akim>,
+  Sebeke<10276, 2, 10, false, &ElektrikselSistem::NeutralAkim>,
+  Jenerator<10278, 2, 10, false, &ElektrikselSistem::NeutralAkim>,
+  // Faz güçleri: aktif (kW), reaktif (kVAr), görünür (kVA), güç faktörü
+  Sebeke<10280, 2, 10, true, &ElektrikselSistem::L1, &FazVerisi::AktifGuc>,
+  Sebeke<10282, 2, 10, true, &ElektrikselSistem::L2, &FazVerisi::AktifGuc>,
+  Sebeke<10284, 2, 10, true, &ElektrikselSistem::L3, &FazVerisi::AktifGuc>,
+  Jenerator<10286, 2, 10, true, &ElektrikselSistem::L1, &FazVerisi::AktifGuc>,
+  Jenerator<10288, 2, 10, true, &ElektrikselSistem::L2, &FazVerisi::AktifGuc>,
+  Jenerator<10290, 2, 10, true, &ElektrikselSistem::L3, &FazVerisi::AktifGuc>,
+  Sebeke<10296, 2, 10, true, &ElektrikselSistem::L1, &FazVerisi::ReaktifGuc>,
+  Sebeke<10298, 2, 10, true, &ElektrikselSistem::L2, &FazVerisi::ReaktifGuc>,
+  Sebeke<10300, 2, 10, true, &ElektrikselSistem::L3, &FazVerisi::ReaktifGuc>,
+  Jenerator<10302, 2, 10, true, &ElektrikselSistem::L1, &FazVerisi::ReaktifGuc>,
+  Jenerator<10304, 2, 10, true, &ElektrikselSistem::L2, &FazVerisi::ReaktifGuc>,
+  Jenerator<10306, 2, 10, true, &ElektrikselSistem::L3, &FazVerisi::ReaktifGuc>,
+  Sebeke<10312, 2, 10, false, &ElektrikselSistem::L1, &FazVerisi::GorunurGuc>,
+  Sebeke<10314, 2, 10, false, &ElektrikselSistem::L2, &FazVerisi::GorunurGuc>,
+  Sebeke<10316, 2, 10, false, &ElektrikselSistem::L3, &FazVerisi::GorunurGuc>,
+  Jenerator<10318, 2, 10, false, &ElektrikselSistem::L1, &FazVerisi::GorunurGuc>,
+  Jenerator<10320, 2, 10, false, &ElektrikselSistem::L2, &FazVerisi::GorunurGuc>,
+  Jenerator<10322, 2, 10, false, &ElektrikselSistem::L3, &FazVerisi::GorunurGuc>,
+  Sebeke<10328, 1, 100, true, &ElektrikselSistem::L1, &FazVerisi::GucFaktoru>,
+  Sebeke<10329, 1, 100, true, &ElektrikselSistem::L2, &FazVerisi::GucFaktoru>,
+  Sebeke<10330, 1, 100, true, &ElektrikselSistem::L3, &FazVerisi::GucFaktoru>,
+  Jenerator<10331, 1, 100, true, &ElektrikselSistem::L1, &FazVerisi::GucFaktoru>,
+  Jenerator<10332, 1, 100, true, &ElektrikselSistem::L2, &FazVerisi::GucFaktoru>,
+  Jenerator<10333, 1, 100, true, &ElektrikselSistem::L3, &FazVerisi::GucFaktoru>,
+  // Toplam güçler
+  Sebeke<10292, 2, 10, true, &ElektrikselSistem::Toplam, &ToplamVerisi::AktifGuc>,
+  Jenerator<10294, 2, 10, true, &ElektrikselSistem::Toplam, &ToplamVerisi::AktifGuc>,
+  Sebeke<10308, 2, 10, true, &ElektrikselSistem::Toplam, &ToplamVerisi::ReaktifGuc>,
+  Jenerator<10310, 2, 10, true, &ElektrikselSistem::Toplam, &ToplamVerisi::ReaktifGuc>,
+  Sebeke<10324, 2, 10, false, &ElektrikselSistem::Toplam, &ToplamVerisi::GorunurGuc>,
+  Jenerator<10326, 2, 10, false, &ElektrikselSistem::Toplam, &ToplamVerisi::GorunurGuc>,
+  // Güç faktörleri
+  Sebeke<10334, 1, 100, true, &ElektrikselSistem::Toplam, &ToplamVerisi::GucFaktoru>,
+  Jenerator<10335, 1, 100, true, &ElektrikselSistem::Toplam, &ToplamVerisi::GucFaktoru>,
+  // Frekanslar
+  Sebeke<10338, 1, 100, false, &ElektrikselSistem::Frekans>,
+  Jenerator<10339, 1, 100, false, &ElektrikselSistem::Frekans>,
+  // Ortalama değerler
+  Jenerator<10377, 2, 10, false, &ElektrikselSistem::Toplam, &ToplamVerisi::OrtalamaVoltaj>,
+  Jenerator<10379, 2, 10, false, &ElektrikselSistem::Toplam, &ToplamVerisi::OrtalamaAkim>,
+  Sebeke<10381, 2, 10, false, &ElektrikselSistem::Toplam, &ToplamVerisi::OrtalamaVoltaj>,
+  Sebeke<10383, 2, 10, false, &ElektrikselSistem::Toplam, &ToplamVerisi::OrtalamaAkim>
+>;
+
+using MotorRegisterlari = RegisterGrubu<
+  Motor<10340, 1, 100, false, &MotorVerileri::SarjVoltaji>,
+  Motor<10341, 1, 100, false, &MotorVerileri::BataryaVoltaji>,
+  Motor<10361, 1, 10, false, &MotorVerileri::YagBasinci>,
+  Motor<10362, 1, 10, true, &MotorVerileri::Sicaklik>,
+  Motor<10363, 1, 10, false, &MotorVerileri::YakitSeviyesi>,
+  Motor<10364, 1, 10, true, &MotorVerileri::YagSicakligi>,
+  Motor<10365, 1, 10, true, &MotorVerileri::KanopyicSicaklik>,
+  Motor<10366, 1, 10, true, &MotorVerileri::OrtamSicakligi>,
+  Motor<10376, 1, 1, false, &MotorVerileri::RPM>,
+  Motor<10385, 1, 100, false, &MotorVerileri::MinBataryaVoltaji>,
+  Motor<11173, 1, 10, true, &MotorVerileri::SarjAkimi>
+>;
+
+using DurumRegisterlari = RegisterGrubu<
+  Sistem<10604, 1, 1, false, &SistemDurumu::Durum>,
+  Sistem<10605, 1, 1, false, &SistemDurumu::Mod>,
+  Sistem<10606, 1, 1, false, &SistemDurumu::OperasyonZamanlayici>,
+  Sistem<10607, 1, 10, true, &SistemDurumu::GOVKontrolCikis>,
+  Sistem<10608, 1, 10, true, &SistemDurumu::AVRKontrolCikis>,
+  Sistem<10609, 1, 1, false, &SistemDurumu::CihazKimlik>,
+  Sistem<10610, 1, 1, false, &SistemDurumu::DonanımVersiyon>,
+  Sistem<10611, 1, 1, false, &SistemDurumu::YazilimVersiyon>
+>;
+
+using SayacRegisterlari = RegisterGrubu<
+  Sayac<10616, 2, 1, false, &Sayaclar::JeneratorCalismaAdedi>,
+  Sayac<10618, 2, 1, false, &Sayaclar::JeneratorMarsAdedi>,
+  Sayac<10620, 2, 1, false, &Sayaclar::JeneratorYukluCalisma>,
+  Sayac<10622, 2, 100, false, &Sayaclar::MotorCalismaSaati>,
+  Sayac<10624, 2, 100, false, &Sayaclar::SonServistenBeriSaat>,
+  Sayac<10626, 2, 100, false, &Sayaclar::SonServistenBeriGun>,
+  Sayac<10628, 2, 10, false, &Sayaclar::ToplamAktifEnerji>,
+  Sayac<10630, 2, 10, false, &Sayaclar::ToplamReaktifEnerjiInd>,
+  Sayac<10632, 2, 10, false, &Sayaclar::ToplamReaktifEnerjiCap>,
+  Sayac<11577, 2, 10, false, &Sayaclar::YakitSayaci>,
+  Sayac<11680, 2, 10, false, &Sayaclar::FlowMeter>
+>;
+
+using AnalogRegisterlari = RegisterGrubu<
+  Analog<10345, 1, 1, false, &AnalogGirisler::Analog1Ohm>,
+  Analog<10346, 1, 1, false, &AnalogGirisler::Analog2Ohm>,
+  Analog<10347, 1, 1, false, &AnalogGirisler::Analog3Ohm>,
+  Analog<10348, 1, 1, false, &AnalogGirisler::Analog4Ohm>,
+  Analog<10349, 1, 1, false, &AnalogGirisler::Analog5Ohm>,
+  Analog<10350, 1, 1, false, &AnalogGirisler::Analog6Ohm>,
+  Analog<10351, 1, 1, false, &AnalogGirisler::Analog7Deger>,
+  Analog<10352, 1, 1, false, &AnalogGirisler::Analog8Deger>
+>;
+
+using GPSIletisimRegisterlari = RegisterGrubu<
+  FloatRegister<10594, &D300Veri::GPS, &GPS_Veriler::Enlem>,
+  FloatRegister<10596, &D300Veri::GPS, &GPS_Veriler::Boylam>,
+  FloatRegister<10598, &D300Veri::GPS, &GPS_Veriler::Yukseklik>,
+  Register<10646, 2, 1, false, &D300Veri::Iletisim, &IletisimVerileri::GPRS_IP>,
+  Register<11682, 1, 1, false, &D300Veri::Iletisim, &IletisimVerileri::EthernetResetSayaci>,
+  Register<11683, 1, 1, false, &D300Veri::Iletisim, &IletisimVerileri::EthernetTCPPaketSayaci>
+>;
+
+// Alarm bitmap'i tek blok okunur; bit değişimleri controller'da işlenir
+inline constexpr RegisterAraligi ALARM_ARALIGI[] = {{ALARM_BASLANGIC_ADRESI, ALARM_KELIME_SAYISI}};
+inline constexpr BlokPlani ALARM_PLANI = planla(ALARM_ARALIGI, 1);
+
+// Hat boşta kaldığında bağlantı yoklaması cihaz kimliğini okur
+static const uint16_t KIMLIK_ADRESI = 10609;
+inline constexpr RegisterAraligi KIMLIK_ARALIGI[] = {{KIMLIK_ADRESI, 1}};
+inline constexpr BlokPlani KIMLIK_PLANI = planla(KIMLIK_ARALIGI, 1);
+
+// Komut onayı sadece ünite durumu ve modunu (10604/10605) okur
+static const uint16_t ONAY_ADRESI = 10604;
+inline constexpr RegisterAraligi ONAY_ARALIGI[] = {{ONAY_ADRESI, 2}};
+inline constexpr BlokPlani ONAY_PLANI = planla(ONAY_ARALIGI, 1);
+
+// Harmonik spektrumu tek blok okunur: THD, temel, H3-H31 (% x100) ve seçili kanal
+static const uint16_t HARMONIK_ADRESI = 10386;
+inline constexpr RegisterAraligi HARMONIK_ARALIGI[] = {{HARMONIK_ADRESI, HARMONIK_REGISTER_SAYISI}};
+inline constexpr BlokPlani HARMONIK_PLANI = planla(HARMONIK_ARALIGI, 1);
+
+// updateBasicData() ve updateData() planları
+using TemelRegisterlar = Birlestir<ElektrikRegisterlari, MotorRegisterlari, DurumRegisterlari>::Tip;
+using EkRegisterlar = Birlestir<SayacRegisterlari, AnalogRegisterlari>::Tip;
+
+// Register desteği yoklaması (probeRegisterSupport) tüm haritayı tarar
+using TumRegisterlar = Birlestir<ElektrikRegisterlari, MotorRegisterlari, DurumRegisterlari,
+                                 SayacRegisterlari, AnalogRegisterlari, GPSIletisimRegisterlari>::Tip;
+
+// Ham register görüntüsü: tüm harita, alarm bitmap'i ve harmonik spektrumu
+constexpr AralikListesi<TumRegisterlar::alanSayisi + 2> goruntuAraliklari() {
+  AralikListesi<TumRegisterlar::alanSayisi + 2> s;
+  for (uint8_t i = 0; i < TumRegisterlar::alanSayisi; i++) {
+    s.a[i] = TumRegisterlar::sirali.a[i];
+  }
+  s.a[TumRegisterlar::alanSayisi] = ALARM_ARALIGI[0];
+  s.a[TumRegisterlar::alanSayisi + 1] = HARMONIK_ARALIGI[0];
+  return sirala(s);
+}
+inline constexpr GoruntuDuzeni GORUNTU = goruntuPlanla(goruntuAraliklari().a, TumRegisterlar::alanSayisi + 2);
+
+// Okumalar doğrudan görüntüye yapılır; her plan görüntü içinde kalmalı
+static_assert(!GORUNTU.tasti && GORUNTU.boyut <= MAX_HAM_GORUNTU, "Ham register görüntüsü kapasiteyi aşıyor");
+static_assert(GORUNTU.kapsar(ElektrikRegisterlari::plan) && GORUNTU.kapsar(MotorRegisterlari::plan) &&
+              GORUNTU.kapsar(DurumRegisterlari::plan) && GORUNTU.kapsar(SayacRegisterlari::plan) &&
+              GORUNTU.kapsar(AnalogRegisterlari::plan) && GORUNTU.kapsar(GPSIletisimRegisterlari::plan) &&
+              GORUNTU.kapsar(TumRegisterlar::plan) && GORUNTU.kapsar(TemelRegisterlar::plan) &&
+              GORUNTU.kapsar(EkRegisterlar::plan) && GORUNTU.kapsar(ALARM_PLANI) &&
+              GORUNTU.kapsar(KIMLIK_PLANI) && GORUNTU.kapsar(ONAY_PLANI) &&
+              GORUNTU.kapsar(HARMONIK_PLANI), "Okuma planı ham görüntünün dışında");
+
+// TumRegisterlar sırasıyla her alanın ham görüntüdeki yeri
+struct OfsetTablosu {
+  uint16_t a[TumRegisterlar::alanSayisi] = {};
+};
+constexpr OfsetTablosu alanOfsetleri() {
+  OfsetTablosu t;
+  for (uint8_t i = 0; i < TumRegisterlar::alanSayisi; i++) {
+    t.a[i] = GORUNTU.ofsetBul(TumRegisterlar::sirali.a[i].adres, TumRegisterlar::sirali.a[i].genislik);
+  }
+  return t;
+}
+inline constexpr OfsetTablosu ALAN_OFSETLERI = alanOfsetleri();
+
+// Ham görüntüden sabit noktalı değer; adres derleme zamanında doğrulanır
+template <uint16_t Adres>
+constexpr auto sabitDeger(const uint16_t* ham) {
+  using R = typename TumRegisterlar::template Bul<Adres>;
+  static_assert(!std::is_void<R>::value, "Adres register haritasında yok");
+  constexpr int16_t ofset = GORUNTU.ofsetBul(R::adres, R::genislik);
+  return R::sabit(ham + ofset);
+}
+
+// İstek bütçeleri - bir register eklenince plan büyürse derleme burada durur
+static_assert(ElektrikRegisterlari::plan.adet <= 2, "Elektriksel veriler 2 istekten fazla tutuyor");
+static_assert(MotorRegisterlari::plan.adet <= 2, "Motor verileri 2 istekten fazla tutuyor");
+static_assert(DurumRegisterlari::plan.adet == 1, "Durum register'ları tek istekte okunmalı");
+static_assert(TemelRegisterlar::plan.adet <= 4, "updateBasicData() 4 istekten fazla tutuyor");
+static_assert(EkRegisterlar::plan.adet <= 4, "updateData() ek okuması 4 istekten fazla tutuyor");
+static_assert(ALARM_PLANI.adet == 1, "Alarm register'ları tek istekte okunmalı");
+static_assert(TumRegisterlar::alanSayisi <= MAX_HARITA_REGISTER, "Register desteği tablosu haritaya yetmiyor");
+static_assert(GPSIletisimRegisterlari::plan.adet <= 3, "GPS/iletişim verileri 3 istekten fazla tutuyor");
+
+} // namespace D300Map
+
+template <uint16_t Adres>
+auto D300Controller::getSabit() const {
+  return D300Map::sabitDeger<Adres>(yerel.Ham);
+}
+
+#endif // D300_REGISTER_MAP_H
@@ -0,0 +1,163 @@
+/*
+ * D300SabitNokta.h
+ * D-300 MK3 Modbus RTU Library for ESP32
+ * Sabit noktalı mühendislik birimleri - ondalık basamak sayısı tipte tutulur
+ *
+ * D-300 değerleri tamsayı register'lardır (230.1 V = 2301, katsayı 10).
+ * SabitNokta<1> bu ham değeri olduğu gibi saklar; toplama, çarpma, bölme,
+ * karekök ve metne çevirme float kullanmadan yapılır ve değer cihazdaki
+ * tamsayıya birebir geri döner. Çarpımın basamak sayısı tiplerin
+ * toplamıdır, farklı basamaklı değerler ancak olcekle<>() ile toplanır.
+ */
+
+#ifndef D300_SABIT_NOKTA_H
+#define D300_SABIT_NOKTA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+namespace D300Sabit {
+
+constexpr int64_t us10(uint8_t n) {
+  int64_t sonuc = 1;
+  while (n--) sonuc *= 10;
+  return sonuc;
+}
+
+// Katsayı 10'un kuvveti olmalı (1, 10, 100...); basamak sayısını döner
+constexpr int8_t basamak(uint32_t katsayi) {
+  int8_t n = 0;
+  while (katsayi > 1) {
+    if (katsayi % 10 != 0) return -1;
+    katsayi /= 10;
+    n++;
+  }
+  return n;
+}
+
+// Sıfırdan uzağa yuvarlayan tamsayı bölme
+constexpr int64_t yuvarlaBol(int64_t pay, int64_t payda) {
+  return ((pay < 0) != (payda < 0)) ? (pay - payda / 2) / payda : (pay + payda / 2) / payda;
+}
+
+constexpr uint32_t karekok(uint64_t x) {
+  // Bit bit tamsayı karekök; sonuç aşağı yuvarlanır
+  uint64_t sonuc = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+  while (bit > x) bit >>= 2;
+  while (bit) {
+    if (x >= sonuc + bit) {
+      x -= sonuc + bit;
+      sonuc = (sonuc >> 1) + bit;
+    } else {
+      sonuc >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)sonuc;
+}
+
+// Tamsayı işlemleriyle "-12.34" biçiminde yazar; sonlandırıcı hariç uzunluğu döner
+inline size_t yaz(char* tampon, size_t boyut, int64_t ham, uint8_t ondalik) {
+  char gecici[24];
+  size_t n = 0;
+  uint64_t deger = ham < 0 ? (uint64_t)(-ham) : (uint64_t)ham;
+  uint8_t hane = 0;
+  do {
+    gecici[n++] = '0' + (deger % 10);
+    deger /= 10;
+    if (++hane == ondalik) gecici[n++] = '.';
+  } while (deger > 0 || hane <= ondalik);
+  if (ham < 0) gecici[n++] = '-';
+
+  size_t uzunluk = 0;
+  while (n > 0 && uzunluk + 1 < boyut) {
+    tampon[uzunluk++] = gecici[--n];
+  }
+  if (boyut > 0) tampon[uzunluk] = '\0';
+  return uzunluk;
+}
+
+} // namespace D300Sabit
+
+template <uint8_t Ondalik, typename T = int32_t>
+struct SabitNokta {
+  static_assert(Ondalik <= 9, "En fazla 9 ondalık basamak");
+  static_assert(std::is_same<T, int32_t>::value || std::is_same<T, int64_t>::value,
+                "Ham değer int32_t ya da int64_t olmalı");
+
+  static constexpr uint8_t ondalik = Ondalik;
+  static constexpr int64_t carpan = D300Sabit::us10(Ondalik);
+
+  T ham = 0;
+
+  static constexpr SabitNokta hamdan(T deger) {
+    SabitNokta s;
+    s.ham = deger;
+    return s;
+  }
+  static constexpr SabitNokta tamsayidan(int32_t deger) { return hamdan((T)(deger * carpan)); }
+
+  constexpr int32_t tamKisim() const { return (int32_t)(ham / carpan); }
+  float toFloat() const { return (float)ham / carpan; }
+
+  // Basamak sayısını değiştirir; azalırken yuvarlar
+  template <uint8_t Yeni, typename YeniT = T>
+  constexpr SabitNokta<Yeni, YeniT> olcekle() const {
+    if constexpr (Yeni >= Ondalik) {
+      return SabitNokta<Yeni, YeniT>::hamdan((YeniT)(ham * D300Sabit::us10(Yeni - Ondalik)));
+    } else {
+      return SabitNokta<Yeni, YeniT>::hamdan((YeniT)D300Sabit::yuvarlaBol(ham, D300Sabit::us10(Ondalik - Yeni)));
+    }
+  }
+
+  constexpr SabitNokta operator+(SabitNokta b) const { return hamdan(ham + b.ham); }
+  constexpr SabitNokta operator-(SabitNokta b) const { return hamdan(ham - b.ham); }
+  constexpr SabitNokta operator-() const { return hamdan(-ham); }
+  constexpr SabitNokta carp(int32_t k) const { return hamdan((T)(ham * k)); }
+
+  // Çarpım 64 bitte tutulur, basamaklar toplanır
+  template <uint8_t B, typename BT>
+  constexpr SabitNokta<Ondalik + B, int64_t> operator*(SabitNokta<B, BT> b) const {
+    return SabitNokta<Ondalik + B, int64_t>::hamdan((int64_t)ham * b.ham);
+  }
+
+  // Sonucun basamak sayısı çağıran tarafından seçilir; payda sıfırsa 0
+  template <uint8_t Sonuc, uint8_t B, typename BT>
+  constexpr SabitNokta<Sonuc> bol(SabitNokta<B, BT> b) const {
+    static_assert(Sonuc + B >= Ondalik, "Bölümün basamak sayısı çok küçük");
+    if (b.ham == 0) return SabitNokta<Sonuc>();
+    return SabitNokta<Sonuc>::hamdan((int32_t)D300Sabit::yuvarlaBol(
+      (int64_t)ham * D300Sabit::us10(Sonuc + B - Ondalik), b.ham));
+  }
+
+  // Karekök basamak sayısını yarıya indirir (örn. güç karesi -> güç)
+  constexpr SabitNokta<Ondalik / 2> karekok() const {
+    static_assert(Ondalik % 2 == 0, "Karekök için basamak sayısı çift olmalı");
+    return SabitNokta<Ondalik / 2>::hamdan(ham > 0 ? (int32_t)D300Sabit::karekok((uint64_t)ham) : 0);
+  }
+
+  constexpr bool operator==(SabitNokta b) const { return ham == b.ham; }
+  constexpr bool operator!=(SabitNokta b) const { return ham != b.ham; }
+  constexpr bool operator<(SabitNokta b) const { return ham < b.ham; }
+  constexpr bool operator>(SabitNokta b) const { return ham > b.ham; }
+
+  size_t yaz(char* tampon, size_t boyut) const {
+    return D300Sabit::yaz(tampon, boyut, ham, Ondalik);
+  }
+
+#ifdef ARDUINO
+  String toString() const {
+    char tampon[24];
+    yaz(tampon, sizeof(tampon));
+    return String(tampon);
+  }
+#endif
+};
+
+#endif // D300_SABIT_NOKTA_H
@@ -0,0 +1,364 @@
+/*
+ * D300Sema.h
+ * D-300 MK3 Modbus RTU Library for ESP32
+ * Alan kataloğu ve çıktı şemaları
+ *
+ * Her alan bir Alan<...> tipidir: D300Veri kökünden yolu, birimi ve basamak
+ * sayısı tek yerde tanımlanır. Bir şema, alanları sırayla bir ziyaretçiye
+ * veren gez() fonksiyonudur; ziyaretçi değeri ara belge kurmadan doğrudan
+ * yazar (JSON için JsonZiyaretci). Şema bir alanı başka birimde isterse
+ * (kW -> W gibi) dönüşüm burada yapılır; uyumsuz birim derlenmez.
+ *
+ * Ziyaretçi arayüzü: nesneBasla(ad), nesneBitir(), diziBasla(ad), diziBitir(),
+ * sayi(ad, ham, ondalik), bos(ad), mantik(ad, b), metin(ad, s).
+ * Dizi elemanlarında ad nullptr'dır.
+ */
+
+#ifndef D300_SEMA_H
+#define D300_SEMA_H
+
+#include <math.h>
+#include <type_traits>
+#include "D300Controller.h"
+#include "D300JsonYazici.h"
+#include "D300SabitNokta.h"
+
+namespace D300Sema {
+
+enum class Birim : uint8_t {
+  Yok,
+  Volt,
+  Amper,
+  Hertz,
+  Watt,
+  Kilowatt,
+  Oran,         // 0-1
+  Yuzde,
+  Derece,
+  Bar,
+  Rpm,
+  Saat,
+  Saniye
+};
+
+// Kaynak birimden hedef birime tamsayı çarpan; çevrilemiyorsa 0
+constexpr int32_t donusum(Birim kaynak, Birim hedef) {
+  if (kaynak == hedef) return 1;
+  if (kaynak == Birim::Kilowatt && hedef == Birim::Watt) return 1000;
+  if (kaynak == Birim::Oran && hedef == Birim::Yuzde) return 100;
+  if (kaynak == Birim::Saat && hedef == Birim::Saniye) return 3600;
+  return 0;
+}
+
+// Tek alan tanımı. Yol, D300Veri kökünden alana giden üye işaretçileridir.
+template <Birim B, uint8_t Ondalik, auto... Yol>
+struct Alan {
+  static constexpr Birim birim = B;
+  static constexpr uint8_t ondalik = Ondalik;
+
+  static auto oku(const D300Veri& veri) { return (veri .* ... .* Yol); }
+};
+
+// Kök kısayolları
+template <Birim B, uint8_t O, auto... Yol>
+using SebekeAlani = Alan<B, O, &D300Veri::ElektrikSistemi, &ElektrikSistemiVerisi::Sebeke, Yol...>;
+
+template <Birim B, uint8_t O, auto... Yol>
+using JeneratorAlani = Alan<B, O, &D300Veri::ElektrikSistemi, &ElektrikSistemiVerisi::Jenerator, Yol...>;
+
+template <Birim B, uint8_t O, auto... Yol>
+using MotorAlani = Alan<B, O, &D300Veri::Motor, Yol...>;
+
+template <Birim B, uint8_t O, auto... Yol>
+using SistemAlani = Alan<B, O, &D300Veri::Sistem, Yol...>;
+
+template <Birim B, uint8_t O, auto... Yol>
+using SayacAlani = Alan<B, O, &D300Veri::Sayac, Yol...>;
+
+// ---------------------------------------------------------------------------
+// Alan kataloğu (birim ve basamak D-300 register çözünürlüğüyle aynı)
+// ---------------------------------------------------------------------------
+
+using SebekeVoltajL1 = SebekeAlani<Birim::Volt, 1, &ElektrikselSistem::L1, &FazVerisi::Voltaj>;
+using SebekeVoltajL2 = SebekeAlani<Birim::Volt, 1, &ElektrikselSistem::L2, &FazVerisi::Voltaj>;
+using SebekeVoltajL3 = SebekeAlani<Birim::Volt, 1, &ElektrikselSistem::L3, &FazVerisi::Voltaj>;
+using SebekeFrekans = SebekeAlani<Birim::Hertz, 1, &ElektrikselSistem::Frekans>;
+using SebekeAktifGuc = SebekeAlani<Birim::Kilowatt, 1, &ElektrikselSistem::Toplam, &ToplamVerisi::AktifGuc>;
+
+using JeneratorVoltajL1 = JeneratorAlani<Birim::Volt, 1, &ElektrikselSistem::L1, &FazVerisi::Voltaj>;
+using JeneratorVoltajL2 = JeneratorAlani<Birim::Volt, 1, &ElektrikselSistem::L2, &FazVerisi::Voltaj>;
+using JeneratorVoltajL3 = JeneratorAlani<Birim::Volt, 1, &ElektrikselSistem::L3, &FazVerisi::Voltaj>;
+using JeneratorFrekans = JeneratorAlani<Birim::Hertz, 1, &ElektrikselSistem::Frekans>;
+using JeneratorAktifGuc = JeneratorAlani<Birim::Kilowatt, 1, &ElektrikselSistem::Toplam, &ToplamVerisi::AktifGuc>;
+using JeneratorL1Guc = JeneratorAlani<Birim::Kilowatt, 1, &ElektrikselSistem::L1, &FazVerisi::AktifGuc>;
+using JeneratorL2Guc = JeneratorAlani<Birim::Kilowatt, 1, &ElektrikselSistem::L2, &FazVerisi::AktifGuc>;
+using JeneratorL3Guc = JeneratorAlani<Birim::Kilowatt, 1, &ElektrikselSistem::L3, &FazVerisi::AktifGuc>;
+using JeneratorGucFaktoru = JeneratorAlani<Birim::Oran, 2, &ElektrikselSistem::Toplam, &ToplamVerisi::GucFaktoru>;
+using JeneratorVoltajDengesizligi = JeneratorAlani<Birim::Yuzde, 1, &ElektrikselSistem::VoltajDengesizligi>;
+using JeneratorAkimDengesizligi = JeneratorAlani<Birim::Yuzde, 1, &ElektrikselSistem::AkimDengesizligi>;
+using JeneratorFazFazSapmasi = JeneratorAlani<Birim::Yuzde, 1, &ElektrikselSistem::FazFazSapmasi>;
+using JeneratorYukYuzdesi = JeneratorAlani<Birim::Yuzde, 1, &ElektrikselSistem::YukYuzdesi>;
+
+using MotorRpm = MotorAlani<Birim::Rpm, 0, &MotorVerileri::RPM>;
+using MotorSicaklik = MotorAlani<Birim::Derece, 1, &MotorVerileri::Sicaklik>;
+using MotorYagBasinci = MotorAlani<Birim::Bar, 1, &MotorVerileri::YagBasinci>;
+using MotorYakitSeviyesi = MotorAlani<Birim::Yuzde, 1, &MotorVerileri::YakitSeviyesi>;
+using MotorHariciYakitSeviyesi = MotorAlani<Birim::Yuzde, 1, &MotorVerileri::HariciYakitSeviyesi>;
+using MotorBataryaVoltaji = MotorAlani<Birim::Volt, 1, &MotorVerileri::BataryaVoltaji>;
+
+using SistemDurumKodu = SistemAlani<Birim::Yok, 0, &SistemDurumu::Durum>;
+using SistemModu = SistemAlani<Birim::Yok, 0, &SistemDurumu::Mod>;
+using SistemKapatmaAlarmi = SistemAlani<Birim::Yok, 0, &SistemDurumu::KapatmaAlarmi>;
+using SistemYukAtmaAlarmi = SistemAlani<Birim::Yok, 0, &SistemDurumu::YukAtmaAlarmi>;
+using SistemUyariAlarmi = SistemAlani<Birim::Yok, 0, &SistemDurumu::UyariAlarmi>;
+
+using SayacMotorCalismaSaati = SayacAlani<Birim::Saat, 2, &Sayaclar::MotorCalismaSaati>;
+
+// Alanı istenen birim ve basamakla ziyaretçiye verir
+template <typename A, Birim Hedef = A::birim, uint8_t Ondalik = A::ondalik, typename Z>
+void alan(Z& z, const char* ad, const D300Veri& veri) {
+  constexpr int32_t carpan = donusum(A::birim, Hedef);
+  static_assert(carpan > 0, "Alanın birimi istenen birime çevrilemez");
+  constexpr int64_t olcek = carpan * D300Sabit::us10(Ondalik);
+
+  auto deger = A::oku(veri);
+  using Tip = decltype(deger);
+  if constexpr (std::is_same<Tip, bool>::value) {
+    z.mantik(ad, deger);
+  } else if constexpr (std::is_enum<Tip>::value) {
+    z.sayi(ad, (int64_t)static_cast<typename std::underlying_type<Tip>::type>(deger) * olcek, Ondalik);
+  } else if constexpr (std::is_floating_point<Tip>::value) {
+    // Birim dönüşümünde float'ın 24 bitlik mantisi yetmez (saat -> saniye)
+    using Hesap = typename std::conditional<(carpan > 1), double, float>::type;
+    Hesap olcekli = (Hesap)deger * (Hesap)olcek;
+    if (isfinite(olcekli)) {
+      z.sayi(ad, (int64_t)llround(olcekli), Ondalik);
+    } else {
+      z.bos(ad);
+    }
+  } else {
+    z.sayi(ad, (int64_t)deger * olcek, Ondalik);
+  }
+}
+
+// Bilinmeyen durumlar "Bilinmeyen (N)" olarak; tampon en az 24 bayt
+inline const char* durumMetni(UniteDurumu durum, char* tampon, size_t boyut) {
+  const char* metin = D300Controller::getDurumMetni(durum);
+  if (metin) return metin;
+  static const char ONEK[] = "Bilinmeyen (";
+  size_t n = sizeof(ONEK) - 1;
+  memcpy(tampon, ONEK, n);
+  n += D300Sabit::yaz(tampon + n, boyut - n - 1, static_cast<uint16_t>(durum), 0);
+  tampon[n++] = ')';
+  tampon[n] = '\0';
+  return tampon;
+}
+
+// ---------------------------------------------------------------------------
+// Şemalar
+// ---------------------------------------------------------------------------
+
+// Web API (generator_web generator_data): düz alanlar, güç W, güç faktörü %
+struct WebApi {
+  template <typename Z>
+  static void gez(const D300Controller& c, Z& z) {
+    char tampon[24];
+    z.nesneBasla(nullptr);
+
+    // Temel durum bilgileri
+    z.metin("CalismaDurumu", durumMetni(c.Sistem.Durum, tampon, sizeof(tampon)));
+    alan<SistemModu>(z, "OperationMode", c);
+    alan<SayacMotorCalismaSaati, Birim::Saniye, 0>(z, "SistemCalismaSuresi", c);
+
+    // Şebeke verileri
+    alan<SebekeVoltajL1>(z, "SebekeVoltaj_l1", c);
+    alan<SebekeVoltajL2>(z, "SebekeVoltaj_l2", c);
+    alan<SebekeVoltajL3>(z, "SebekeVoltaj_l3", c);
+    alan<SebekeFrekans>(z, "SebekeHz", c);
+    alan<SebekeAktifGuc, Birim::Watt, 0>(z, "ToplamGuc", c);
+    z.mantik("SebekeDurumu", c.isSebekeMevcut());
+
+    // Jeneratör verileri
+    alan<JeneratorVoltajL1>(z, "GenVoltaj_l1", c);
+    alan<JeneratorVoltajL2>(z, "GenVoltaj_l2", c);
+    alan<JeneratorVoltajL3>(z, "GenVoltaj_l3", c);
+    alan<JeneratorFrekans>(z, "GenHz", c);
+    alan<JeneratorAktifGuc, Birim::Watt, 0>(z, "GenUretilenGuc", c);
+    alan<JeneratorGucFaktoru, Birim::Yuzde, 1>(z, "GenGucFaktoru", c);
+
+    // Motor verileri
+    alan<MotorRpm>(z, "MotorRpm", c);
+    alan<MotorSicaklik>(z, "MotorSicaklik", c);
+    alan<MotorYagBasinci>(z, "YagBasinci", c);
+    alan<MotorYakitSeviyesi>(z, "YakitSeviyesi", c);
+    alan<MotorBataryaVoltaji>(z, "BataryaVoltaji", c);
+    z.sayi("timestamp", millis(), 0);
+
+    // Alarm durumu
+    alan<SistemKapatmaAlarmi>(z, "KapatmaAlarmi", c);
+    alan<SistemYukAtmaAlarmi>(z, "YukAtmaAlarmi", c);
+    alan<SistemUyariAlarmi>(z, "UyariAlarmi", c);
+    z.mantik("SistemSaglikli", c.isSystemHealthy());
+
+    z.nesneBitir();
+  }
+};
+
+// İç içe API (getDataAsJSON): güç kW, güç faktörü 0-1, hat ve alan kalitesi dahil
+struct AyrintiliApi {
+  template <typename Z>
+  static void gez(const D300Controller& c, Z& z) {
+    z.nesneBasla(nullptr);
+    z.sayi("timestamp", millis(), 0);
+    z.mantik("connected", c.getBaglantiDurumu());
+
+    // Elektriksel sistem
+    z.nesneBasla("electrical");
+    z.nesneBasla("mains");
+    z.nesneBasla("voltage");
+    alan<SebekeVoltajL1>(z, "l1", c);
+    alan<SebekeVoltajL2>(z, "l2", c);
+    alan<SebekeVoltajL3>(z, "l3", c);
+    z.nesneBitir();
+    alan<SebekeFrekans>(z, "frequency", c);
+    alan<SebekeAktifGuc>(z, "power", c);
+    z.nesneBitir();
+
+    z.nesneBasla("generator");
+    z.nesneBasla("voltage");
+    alan<JeneratorVoltajL1>(z, "l1", c);
+    alan<JeneratorVoltajL2>(z, "l2", c);
+    alan<JeneratorVoltajL3>(z, "l3", c);
+    z.nesneBitir();
+    alan<JeneratorFrekans>(z, "frequency", c);
+    alan<JeneratorAktifGuc>(z, "power", c);
+    z.diziBasla("phasePower");
+    alan<JeneratorL1Guc>(z, nullptr, c);
+    alan<JeneratorL2Guc>(z, nullptr, c);
+    alan<JeneratorL3Guc>(z, nullptr, c);
+    z.diziBitir();
+    alan<JeneratorGucFaktoru>(z, "powerFactor", c);
+    alan<JeneratorVoltajDengesizligi>(z, "voltageImbalance", c);
+    alan<JeneratorAkimDengesizligi>(z, "currentImbalance", c);
+    alan<JeneratorFazFazSapmasi>(z, "lineDeviation", c);
+    alan<JeneratorYukYuzdesi>(z, "load", c);
+    z.nesneBitir();
+    z.nesneBitir();
+
+    // Motor verileri
+    z.nesneBasla("engine");
+    alan<MotorRpm>(z, "rpm", c);
+    alan<MotorSicaklik>(z, "temperature", c);
+    alan<MotorYagBasinci>(z, "oil_pressure", c);
+    alan<MotorYakitSeviyesi>(z, "fuel_level", c);
+    alan<MotorHariciYakitSeviyesi>(z, "external_fuel_level", c);
+    alan<MotorBataryaVoltaji>(z, "battery_voltage", c);
+    z.nesneBitir();
+
+    // Sistem durumu
+    z.nesneBasla("system");
+    alan<SistemDurumKodu>(z, "status", c);
+    alan<SistemModu>(z, "mode", c);
+    z.nesneBasla("alarms");
+    alan<SistemKapatmaAlarmi>(z, "shutdown", c);
+    alan<SistemYukAtmaAlarmi>(z, "loaddump", c);
+    alan<SistemUyariAlarmi>(z, "warning", c);
+    z.diziBasla("active");
+    for (uint8_t kelime = 0; kelime < ALARM_KELIME_SAYISI; kelime++) {
+      uint16_t bitler = c.Sistem.AlarmBitleri[kelime];
+      while (bitler) {
+        uint8_t bitNo = __builtin_ctz(bitler);
+        bitler &= bitler - 1;
+        z.sayi(nullptr, kelime * 16 + bitNo, 0);
+      }
+    }
+    z.diziBitir();
+    z.nesneBitir();
+    z.nesneBitir();
+
+    // Hat durumu
+    z.nesneBasla("link");
+    z.sayi("baud", c.getBaudRate(), 0);
+    z.sayi("regPerSec", c.getRegisterHizi(), 0);
+    z.sayi("crcErrors", c.getCrcHatasi(), 0);
+    z.sayi("timeouts", c.getZamanAsimiSayisi(), 0);
+    z.nesneBitir();
+
+    // Alan kalitesi: iyi ve hiç okunmamış alanlar sayılır, diğerleri adresleriyle listelenir
+    uint8_t iyi = 0;
+    uint8_t yok = 0;
+    for (uint8_t i = 0; i < c.getAlanSayisi(); i++) {
+      AlanKalitesi kalite = c.getAlanKalitesi(c.getAlanAdresi(i));
+      if (kalite == AlanKalitesi::Iyi) iyi++;
+      else if (kalite == AlanKalitesi::Yok) yok++;
+    }
+    z.nesneBasla("quality");
+    z.sayi("good", iyi, 0);
+    z.sayi("none", yok, 0);
+    z.metin("alarms", c.isAlarmVerisiTaze() ? "good" : "stale");
+    z.nesneBasla("fields");
+    char adres[8];
+    for (uint8_t i = 0; i < c.getAlanSayisi(); i++) {
+      AlanKalitesi kalite = c.getAlanKalitesi(c.getAlanAdresi(i));
+      if (kalite == AlanKalitesi::Iyi || kalite == AlanKalitesi::Yok) continue;
+      D300Sabit::yaz(adres, sizeof(adres), c.getAlanAdresi(i), 0);
+      z.metin(adres, D300Controller::getKaliteAciklama(kalite));
+    }
+    z.nesneBitir();
+    z.nesneBitir();
+
+    z.mantik("healthy", c.isSystemHealthy());
+    z.nesneBitir();
+  }
+};
+
+// Özet (getBasicDataAsJSON): güç kW
+struct TemelApi {
+  template <typename Z>
+  static void gez(const D300Controller& c, Z& z) {
+    z.nesneBasla(nullptr);
+    alan<JeneratorAktifGuc>(z, "gen_power", c);
+    alan<JeneratorFrekans>(z, "gen_freq", c);
+    alan<SebekeFrekans>(z, "mains_freq", c);
+    alan<MotorRpm>(z, "rpm", c);
+    alan<MotorBataryaVoltaji>(z, "battery", c);
+    alan<MotorYakitSeviyesi>(z, "fuel", c);
+    alan<SistemDurumKodu>(z, "status", c);
+    alan<SistemModu>(z, "mode", c);
+    z.mantik("alarms", c.Sistem.KapatmaAlarmi || c.Sistem.YukAtmaAlarmi || c.Sistem.UyariAlarmi);
+    z.mantik("connected", c.getBaglantiDurumu());
+    z.nesneBitir();
+  }
+};
+
+// ---------------------------------------------------------------------------
+// Ziyaretçiler
+// ---------------------------------------------------------------------------
+
+// Şemayı doğrudan JsonYazici'ya yazar
+class JsonZiyaretci {
+public:
+  explicit JsonZiyaretci(JsonYazici& j) : j(j) {}
+
+  void nesneBasla(const char* ad) { if (ad) j.anahtar(ad); j.nesneBasla(); }
+  void nesneBitir() { j.nesneBitir(); }
+  void diziBasla(const char* ad) { if (ad) j.anahtar(ad); j.diziBasla(); }
+  void diziBitir() { j.diziBitir(); }
+  void sayi(const char* ad, int64_t ham, uint8_t ondalik) { if (ad) j.anahtar(ad); j.sabit(ham, ondalik); }
+  void bos(const char* ad) { if (ad) j.anahtar(ad); j.hamDeger("null"); }
+  void mantik(const char* ad, bool b) { if (ad) j.anahtar(ad); j.deger(b); }
+  void metin(const char* ad, const char* s) { if (ad) j.anahtar(ad); j.deger(s); }
+
+private:
+  JsonYazici& j;
+};
+
+template <typename Sema>
+void yazJson(const D300Controller& c, JsonYazici& j) {
+  JsonZiyaretci z(j);
+  Sema::gez(c, z);
+}
+
+} // namespace D300Sema
+
+#endif // D300_SEMA_H
@@ -0,0 +1,393 @@
+/*
+ * D300Telemetri.h
+ * D-300 MK3 Modbus RTU Library for ESP32
+ * İkili telemetri çerçevesi
+ *
+ * Çerçeve (tüm çok baytlı alanlar little-endian):
+ *
+ *   0   2  işaret 'D' '3'
+ *   2   1  şema sürümü
+ *   3   1  çerçeve tipi (0 = tam değerler, 1 = delta)
+ *   4   4  cihaz kimliği
+ *   8   4  sıra numarası
+ *  12   4  zaman (millis)
+ *  16   2  yük uzunluğu (N)
+ *  18   N  yük
+ *  18+N 2  CRC-16/MODBUS (baştan yük sonuna kadar)
+ *
+ * Tam yük, şemanın sayılarını sırasıyla int32 sabit nokta olarak, ardından
+ * mantıksal alanları bit bit (ilk alan bit 0) içerir. Sayıların basamak
+ * sayısı şemada sabittir; sıra, basamak ya da alan değişirse
+ * SEMA_SURUMU artırılmalı ve sunucudaki çözücü güncellenmelidir.
+ *
+ * Delta yükü, sunucunun onayladığı son çerçeveye (taban) göre yazılır:
+ *
+ *   0   4  taban sıra numarası
+ *   4   B  değişim bit haritası, sayı başına bir bit (B = (sayı + 7) / 8)
+ *   4+B .  değişen her sayı için zigzag varint (güncel - taban)
+ *   .   .  mantıksal alanlar, tam yükteki gibi her zaman
+ *
+ * Toplu gönderimde çerçeveler art arda eklenir; bir çerçevenin tabanı aynı
+ * toplulukta kendinden önceki çerçeve olabilir.
+ * Sunucu tabanı bilmiyorsa (yeniden başlatma vb.) 409 döner; kodlayıcı
+ * tabanı unutur ve sonraki çerçeve tam gider.
+ * Sunucu tarafı: generator_web/Models/TelemetryFrame.cs
+ */
+
+#ifndef D300_TELEMETRI_H
+#define D300_TELEMETRI_H
+
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include "D300Sema.h"
+#include "D300ModbusRtu.h"
+
+namespace D300Telemetri {
+
+static const uint8_t ISARET_0 = 'D';
+static const uint8_t ISARET_1 = '3';
+static const uint8_t SEMA_SURUMU = 1;
+static const uint8_t TIP_TAM = 0;
+static const uint8_t TIP_DELTA = 1;
+static const uint8_t BASLIK_BOYUTU = 18;
+static const uint8_t CRC_BOYUTU = 2;
+static const uint8_t MAX_CERCEVE_BOYUTU = 128;    // Sürüm 1 tam çerçeve 97 bayt
+static const int32_t DEGER_YOK = INT32_MIN;     // Sonlu olmayan ya da okunamayan değer
+
+inline void yaz16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+inline void yaz32(uint8_t* p, uint32_t v) {
+  for (uint8_t i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+// Sürüm 1 yükü: web API alanları, metin yerine durum kodu
+struct IkiliApi {
+  template <typename Z>
+  static void gez(const D300Controller& c, Z& z) {
+    using namespace D300Sema;
+    z.nesneBasla(nullptr);
+    alan<SistemDurumKodu>(z, "durum", c);
+    alan<SistemModu>(z, "mod", c);
+    alan<SayacMotorCalismaSaati, Birim::Saniye, 0>(z, "calismaSuresi", c);
+    alan<SebekeVoltajL1, Birim::Volt, 1>(z, "sebekeV1", c);
+    alan<SebekeVoltajL2, Birim::Volt, 1>(z, "sebekeV2", c);
+    alan<SebekeVoltajL3, Birim::Volt, 1>(z, "sebekeV3", c);
+    alan<SebekeFrekans, Birim::Hertz, 1>(z, "sebekeHz", c);
+    alan<SebekeAktifGuc, Birim::Watt, 0>(z, "sebekeGuc", c);
+    alan<JeneratorVoltajL1, Birim::Volt, 1>(z, "jenV1", c);
+    alan<JeneratorVoltajL2, Birim::Volt, 1>(z, "jenV2", c);
+    alan<JeneratorVoltajL3, Birim::Volt, 1>(z, "jenV3", c);
+    alan<JeneratorFrekans, Birim::Hertz, 1>(z, "jenHz", c);
+    alan<JeneratorAktifGuc, Birim::Watt, 0>(z, "jenGuc", c);
+    alan<JeneratorGucFaktoru, Birim::Yuzde, 1>(z, "gucFaktoru", c);
+    alan<MotorRpm, Birim::Rpm, 0>(z, "rpm", c);
+    alan<MotorSicaklik, Birim::Derece, 1>(z, "sicaklik", c);
+    alan<MotorYagBasinci, Birim::Bar, 1>(z, "yagBasinci", c);
+    alan<MotorYakitSeviyesi, Birim::Yuzde, 1>(z, "yakit", c);
+    alan<MotorBataryaVoltaji, Birim::Volt, 1>(z, "batarya", c);
+    z.mantik("sebekeMevcut", c.isSebekeMevcut());
+    alan<SistemKapatmaAlarmi>(z, "kapatma", c);
+    alan<SistemYukAtmaAlarmi>(z, "yukAtma", c);
+    alan<SistemUyariAlarmi>(z, "uyari", c);
+    z.mantik("saglikli", c.isSystemHealthy());
+    z.nesneBitir();
+  }
+};
+
+// Şemanın sayı ve mantıksal değerleri; tam ve delta yük bundan yazılır
+struct Ornek {
+  static const uint8_t MAX_SAYI = 32;
+  static const uint8_t MAX_BAYRAK = 32;
+
+  int32_t sayilar[MAX_SAYI];
+  uint8_t sayiAdet;
+  uint32_t bayraklar;
+  uint8_t bayrakAdet;
+  bool tasma;
+
+  uint8_t bayrakBaytlari() const { return (bayrakAdet + 7) / 8; }
+  uint8_t haritaBaytlari() const { return (sayiAdet + 7) / 8; }
+};
+
+// Şemayı gezip örneğe toplar; adlar ve yapı kullanılmaz
+class OrnekToplayici {
+public:
+  explicit OrnekToplayici(Ornek& ornek) : ornek(ornek) {
+    ornek.sayiAdet = 0;
+    ornek.bayraklar = 0;
+    ornek.bayrakAdet = 0;
+    ornek.tasma = false;
+  }
+
+  void nesneBasla(const char*) {}
+  void nesneBitir() {}
+  void diziBasla(const char*) {}
+  void diziBitir() {}
+  void metin(const char*, const char*) {}       // Metinler ikili şemada yer almaz
+
+  void sayi(const char*, int64_t ham, uint8_t) {
+    if (ham > INT32_MAX) ham = INT32_MAX;
+    if (ham <= INT32_MIN) ham = INT32_MIN + 1;
+    ekle((int32_t)ham);
+  }
+  void bos(const char*) { ekle(DEGER_YOK); }
+  void mantik(const char*, bool b) {
+    if (ornek.bayrakAdet >= Ornek::MAX_BAYRAK) {
+      ornek.tasma = true;
+      return;
+    }
+    if (b) ornek.bayraklar |= (uint32_t)1 << ornek.bayrakAdet;
+    ornek.bayrakAdet++;
+  }
+
+private:
+  Ornek& ornek;
+
+  void ekle(int32_t v) {
+    if (ornek.sayiAdet >= Ornek::MAX_SAYI) {
+      ornek.tasma = true;
+      return;
+    }
+    ornek.sayilar[ornek.sayiAdet++] = v;
+  }
+};
+
+template <typename Sema = IkiliApi>
+bool ornekAl(const D300Controller& c, Ornek& ornek) {
+  OrnekToplayici z(ornek);
+  Sema::gez(c, z);
+  return !ornek.tasma;
+}
+
+inline size_t bayrakYaz(const Ornek& o, uint8_t* p, size_t boyut) {
+  if (o.bayrakBaytlari() > boyut) return 0;
+  for (uint8_t i = 0; i < o.bayrakBaytlari(); i++) p[i] = (uint8_t)(o.bayraklar >> (8 * i));
+  return o.bayrakBaytlari();
+}
+
+// Tam yük; uzunluğu döner, sığmazsa 0
+inline size_t tamYukYaz(const Ornek& o, uint8_t* p, size_t boyut) {
+  size_t n = (size_t)o.sayiAdet * 4;
+  if (n > boyut) return 0;
+  for (uint8_t i = 0; i < o.sayiAdet; i++) yaz32(p + 4 * i, (uint32_t)o.sayilar[i]);
+  size_t b = bayrakYaz(o, p + n, boyut - n);
+  if (b != o.bayrakBaytlari()) return 0;
+  return n + b;
+}
+
+// Küçük mutlak değerli farklar küçük sayılara eşlenir: 0,-1,1,-2 -> 0,1,2,3
+inline uint64_t zigzag(int64_t v) {
+  return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+// 7 bitlik gruplar, düşük grup önce; uzunluğu döner, sığmazsa 0
+inline size_t varintYaz(uint8_t* p, size_t boyut, uint64_t v) {
+  size_t n = 0;
+  do {
+    if (n >= boyut) return 0;
+    uint8_t bayt = v & 0x7F;
+    v >>= 7;
+    p[n++] = v ? (bayt | 0x80) : bayt;
+  } while (v);
+  return n;
+}
+
+// Delta yükü; şema farklıysa ya da sığmazsa 0
+inline size_t deltaYukYaz(const Ornek& o, const Ornek& taban, uint32_t tabanSira,
+                          uint8_t* p, size_t boyut) {
+  if (o.sayiAdet != taban.sayiAdet || o.bayrakAdet != taban.bayrakAdet) return 0;
+
+  size_t harita = o.haritaBaytlari();
+  if (4 + harita > boyut) return 0;
+  yaz32(p, tabanSira);
+  memset(p + 4, 0, harita);
+
+  size_t n = 4 + harita;
+  for (uint8_t i = 0; i < o.sayiAdet; i++) {
+    if (o.sayilar[i] == taban.sayilar[i]) continue;
+    p[4 + i / 8] |= (uint8_t)(1 << (i % 8));
+    size_t v = varintYaz(p + n, boyut - n, zigzag((int64_t)o.sayilar[i] - taban.sayilar[i]));
+    if (v == 0) return 0;
+    n += v;
+  }
+
+  size_t b = bayrakYaz(o, p + n, boyut - n);
+  if (b != o.bayrakBaytlari()) return 0;
+  return n + b;
+}
+
+// Yükü zaten BASLIK_BOYUTU'ndan itibaren yazılmış çerçevenin başlığını ve
+// CRC'sini yazar; çerçeve uzunluğunu döner
+inline size_t cerceveKapat(uint8_t* tampon, uint8_t tip, uint32_t cihazKimligi,
+                           uint32_t sira, uint32_t zaman, size_t yuk) {
+  tampon[0] = ISARET_0;
+  tampon[1] = ISARET_1;
+  tampon[2] = SEMA_SURUMU;
+  tampon[3] = tip;
+  yaz32(tampon + 4, cihazKimligi);
+  yaz32(tampon + 8, sira);
+  yaz32(tampon + 12, zaman);
+  yaz16(tampon + 16, (uint16_t)yuk);
+
+  size_t uzunluk = BASLIK_BOYUTU + yuk;
+  yaz16(tampon + uzunluk, D300ModbusRtu::crc16(tampon, (uint16_t)uzunluk));
+  return uzunluk + CRC_BOYUTU;
+}
+
+// Tam çerçeve; uzunluğu döner, sığmazsa 0
+template <typename Sema = IkiliApi>
+size_t cerceveYaz(const D300Controller& c, uint8_t* tampon, size_t boyut,
+                  uint32_t cihazKimligi, uint32_t sira, uint32_t zaman) {
+  if (boyut < BASLIK_BOYUTU + CRC_BOYUTU) return 0;
+
+  Ornek ornek;
+  if (!ornekAl<Sema>(c, ornek)) return 0;
+  size_t yuk = tamYukYaz(ornek, tampon + BASLIK_BOYUTU, boyut - BASLIK_BOYUTU - CRC_BOYUTU);
+  if (yuk == 0 || yuk > 0xFFFF) return 0;
+  return cerceveKapat(tampon, TIP_TAM, cihazKimligi, sira, zaman, yuk);
+}
+
+// Onaylanan son çerçeveye göre delta, belirli aralıkla ya da taban yokken
+// tam çerçeve üretir. Art arda yazılan çerçeveler (toplu gönderim) bir
+// zincir oluşturur: her biri bir öncekine göre yazılır, zincirBasla() onaylı
+// tabana döner. Gönderim sonucu onayla()/sifirla() ile bildirilir;
+// onaylanmayan çerçeve taban olmaz.
+class DeltaKodlayici {
+public:
+  explicit DeltaKodlayici(uint16_t anahtarAraligi = 60)
+    : anahtarAraligi(anahtarAraligi), tabanSira(0), tabanVar(false), anahtardanBeri(0),
+      zincirSira(0), zincirVar(false), zincirAnahtardanBeri(0), zincirDolu(false),
+      sonTam(false) {}
+
+  // Tek çerçeve: onaylı tabana göre
+  template <typename Sema = IkiliApi>
+  size_t cerceveYaz(const D300Controller& c, uint8_t* tampon, size_t boyut,
+                    uint32_t cihazKimligi, uint32_t sira, uint32_t zaman) {
+    zincirBasla();
+    Ornek ornek;
+    if (!ornekAl<Sema>(c, ornek)) return 0;
+    return cerceveYaz(ornek, tampon, boyut, cihazKimligi, sira, zaman);
+  }
+
+  // Zincirin son çerçevesine göre yazar ve örneği zincire ekler
+  size_t cerceveYaz(const Ornek& ornek, uint8_t* tampon, size_t boyut,
+                    uint32_t cihazKimligi, uint32_t sira, uint32_t zaman) {
+    if (boyut < BASLIK_BOYUTU + CRC_BOYUTU) return 0;
+
+    uint8_t* yukBasi = tampon + BASLIK_BOYUTU;
+    size_t yukBoyut = boyut - BASLIK_BOYUTU - CRC_BOYUTU;
+    size_t tamBoyut = (size_t)ornek.sayiAdet * 4 + ornek.bayrakBaytlari();
+
+    size_t yuk = 0;
+    bool tam = !zincirVar || zincirAnahtardanBeri + 1 >= anahtarAraligi;
+    if (!tam) {
+      yuk = deltaYukYaz(ornek, zincir, zincirSira, yukBasi, yukBoyut);
+      // Çok alan birden değiştiyse delta tam yükten büyük olabilir
+      if (yuk == 0 || yuk >= tamBoyut) tam = true;
+    }
+    if (tam) yuk = tamYukYaz(ornek, yukBasi, yukBoyut);
+    if (yuk == 0 || yuk > 0xFFFF) return 0;
+
+    zincir = ornek;
+    zincirSira = sira;
+    zincirVar = true;
+    zincirAnahtardanBeri = tam ? 0 : zincirAnahtardanBeri + 1;
+    zincirDolu = true;
+    sonTam = tam;
+    return cerceveKapat(tampon, tam ? TIP_TAM : TIP_DELTA, cihazKimligi, sira, zaman, yuk);
+  }
+
+  // Yazılmış ama onaylanmamış çerçeveleri bırakır; zincir onaylı tabandan başlar
+  void zincirBasla() {
+    if (tabanVar) zincir = taban;
+    zincirSira = tabanSira;
+    zincirVar = tabanVar;
+    zincirAnahtardanBeri = anahtardanBeri;
+    zincirDolu = false;
+  }
+
+  // Sunucu zinciri son çerçevesine (sira) kadar kaydetti; sonraki deltalar buna göre yazılır
+  void onayla(uint32_t sira) {
+    if (!zincirDolu || sira != zincirSira) return;
+    taban = zincir;
+    tabanSira = sira;
+    tabanVar = true;
+    anahtardanBeri = zincirAnahtardanBeri;
+    zincirDolu = false;
+  }
+
+  // Sunucu tabanı tanımadı; sonraki çerçeve tam gider
+  void sifirla() {
+    tabanVar = false;
+    zincirBasla();
+  }
+
+  bool sonCerceveTamMi() const { return sonTam; }
+
+private:
+  uint16_t anahtarAraligi;
+  Ornek taban;                    // Onaylanan son örnek
+  uint32_t tabanSira;
+  bool tabanVar;
+  uint16_t anahtardanBeri;        // Son onaylı tam çerçeveden beri onaylanan delta sayısı
+  Ornek zincir;                   // Yazılan son örnek; sonraki çerçevenin tabanı
+  uint32_t zincirSira;
+  bool zincirVar;
+  uint16_t zincirAnahtardanBeri;
+  bool zincirDolu;                // Zincirde onay bekleyen çerçeve var
+  bool sonTam;
+};
+
+// Gönderilmeyi bekleyen örnekler; dolunca en eskinin üzerine yazılır
+// (bağlantı uzun süre yoksa en yeni N örnek tutulur)
+template <uint16_t N>
+class OrnekHalkasi {
+public:
+  struct Kayit {
+    Ornek ornek;
+    uint32_t sira;
+    uint32_t zaman;
+  };
+
+  OrnekHalkasi() : bas(0), adet(0), kayip(0) {}
+
+  // Yeni kayıt; yazılacak alanı döner
+  Kayit& ekle() {
+    if (adet == N) {
+      bas = (bas + 1) % N;
+      adet--;
+      kayip++;
+    }
+    Kayit& k = kayitlar[(bas + adet) % N];
+    adet++;
+    return k;
+  }
+
+  // En eskiden başlayarak i. kayıt
+  const Kayit& operator[](uint16_t i) const { return kayitlar[(bas + i) % N]; }
+
+  // Gönderilen en eski n kaydı çıkarır
+  void dusur(uint16_t n) {
+    if (n > adet) n = adet;
+    bas = (bas + n) % N;
+    adet -= n;
+  }
+
+  uint16_t boyut() const { return adet; }
+  static uint16_t kapasite() { return N; }
+  uint32_t kayipSayisi() const { return kayip; }
+
+private:
+  Kayit kayitlar[N];
+  uint16_t bas;
+  uint16_t adet;
+  uint32_t kayip;
+};
+
+} // namespace D300Telemetri
+
+#endif // D300_TELEMETRI_H
@@ -0,0 +1,103 @@
+/*
+ * D300YakitSensoru.cpp
+ * D-300 MK3 Modbus RTU Library for ESP32
+ * Implementation File - Şamandra örnekleme ve süzme
+ */
+
+#include "D300YakitSensoru.h"
+
+D300YakitSensoru::D300YakitSensoru()
+  : zamanlayici(nullptr), halkaIndeks(0), halkaAdet(0), filtre(0), seviye(0.0f), ornekSayisi(0) {}
+
+bool D300YakitSensoru::begin() {
+  if (zamanlayici != nullptr) return true;
+
+  // ADC pin konfigürasyonu
+  pinMode(FUEL_ADC_PIN, INPUT);
+  analogReadResolution(12);  // 12-bit ADC çözünürlük
+
+  // İlk örnek filtreyi doldurur; seviye zamanlayıcı başlamadan hazırdır
+  sample();
+
+  esp_timer_create_args_t ayar = {};
+  ayar.callback = &D300YakitSensoru::onSample;
+  ayar.arg = this;
+  ayar.name = "d300_yakit";
+  if (esp_timer_create(&ayar, &zamanlayici) != ESP_OK) {
+    zamanlayici = nullptr;
+    return false;
+  }
+  if (esp_timer_start_periodic(zamanlayici, YAKIT_ORNEK_ARALIGI_US) != ESP_OK) {
+    esp_timer_delete(zamanlayici);
+    zamanlayici = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void D300YakitSensoru::onSample(void* arg) {
+  // esp_timer görevinde çalışır; tek bir analogRead birkaç on µs sürer
+  static_cast<D300YakitSensoru*>(arg)->sample();
+}
+
+void D300YakitSensoru::sample() {
+  halka[halkaIndeks] = analogRead(FUEL_ADC_PIN);
+  halkaIndeks = (halkaIndeks + 1) % YAKIT_HALKA_BOYUTU;
+  if (halkaAdet < YAKIT_HALKA_BOYUTU) halkaAdet++;
+
+  // Son örneklerin medyanı: tek örneklik sıçramalar filtreye girmez
+  uint16_t pencere[YAKIT_MEDYAN_PENCERESI] = {};
+  uint8_t adet = halkaAdet < YAKIT_MEDYAN_PENCERESI ? halkaAdet : YAKIT_MEDYAN_PENCERESI;
+  for (uint8_t i = 0; i < adet; i++) {
+    uint16_t deger = halka[(halkaIndeks + YAKIT_HALKA_BOYUTU - 1 - i) % YAKIT_HALKA_BOYUTU];
+    uint8_t j = i;
+    for (; j > 0 && pencere[j - 1] > deger; j--) pencere[j] = pencere[j - 1];
+    pencere[j] = deger;
+  }
+  uint32_t medyan = (uint32_t)pencere[adet / 2] << YAKIT_IIR_KESIR;
+
+  // Tamsayı IIR: y += (x - y) / 2^k; ilk örnek filtreyi doğrudan başlatır
+  if (halkaAdet == 1) {
+    filtre = medyan;
+  } else {
+    filtre = (uint32_t)((int32_t)filtre + (((int32_t)medyan - (int32_t)filtre) >> YAKIT_IIR_KAYDIRMA));
+  }
+
+  // Seviye burada bir kez hesaplanır; okuyucular yalnızca son değeri alır
+  float adcVoltage = ((float)filtre / (1 << YAKIT_IIR_KESIR) / ADC_MAX) * ESP32_VREF;
+  seviye.store(calculateFuelLevel(adcVoltage), std::memory_order_relaxed);
+  ornekSayisi.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Voltage divider'dan yakıt seviyesi hesaplama
+float D300YakitSensoru::calculateFuelLevel(float adcVoltage) {
+  // Voltage divider formülü: Vout = Vin * (R_shamandra) / (R1 + R_shamandra)
+  // R_shamandra = (Vout * R1) / (Vin - Vout)
+
+  if (adcVoltage >= ESP32_VREF || adcVoltage <= 0) {
+    return -1; // Hata durumu
+  }
+
+  // Şamandra direncini hesapla
+  float shamandraResistance = (adcVoltage * (R1 + R2)) / (ESP32_VREF - adcVoltage);
+
+  // Direnci yakıt seviyesine çevir
+  return resistanceToFuelLevel(shamandraResistance);
+}
+
+// Direnç değerini yakıt yüzdesine çevirme
+float D300YakitSensoru::resistanceToFuelLevel(float resistance) {
+  // Linear interpolasyon
+  if (resistance <= FUEL_EMPTY_RESISTANCE) {
+    return 0.0;  // Tank boş
+  }
+  if (resistance >= FUEL_FULL_RESISTANCE) {
+    return 100.0;  // Tank dolu
+  }
+
+  // Doğrusal olarak yakıt seviyesini hesapla
+  float fuelPercent = ((resistance - FUEL_EMPTY_RESISTANCE) /
+                      (FUEL_FULL_RESISTANCE - FUEL_EMPTY_RESISTANCE)) * 100.0;
+
+  return constrain(fuelPercent, 0.0, 100.0);
+}
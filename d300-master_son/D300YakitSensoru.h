@@ -0,0 +1,68 @@
+/*
+ * D300YakitSensoru.h
+ * D-300 MK3 Modbus RTU Library for ESP32
+ * Harici şamandra (ADC) yakıt sensörü
+ *
+ * Sensör karta aittir, ünitelere değil: tek başına kullanılan D300Controller
+ * kendi sensörünü, D300BusYoneticisi ise hattaki tüm üniteler için tek bir
+ * sensörü başlatır. Böylece aynı pin için tek zamanlayıcı ve tek filtre çalışır.
+ */
+
+#ifndef D300_YAKIT_SENSORU_H
+#define D300_YAKIT_SENSORU_H
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+#include <atomic>
+#include <esp_timer.h>
+
+class D300YakitSensoru {
+public:
+  D300YakitSensoru();
+
+  // Periyodik örneklemeyi başlatır; tekrar çağrılırsa bir şey yapmaz
+  bool begin();
+
+  // Filtrenin son çıktısı (%); beklemez, her çağrıda sabit sürede döner
+  float getSeviye() const { return seviye.load(std::memory_order_relaxed); }
+  uint32_t getOrnekSayisi() const { return ornekSayisi.load(std::memory_order_relaxed); }
+
+private:
+  // ADC yakıt sensörü
+  static constexpr uint8_t FUEL_ADC_PIN = 34;
+  static constexpr float R1 = 680.0f;             // Alt direnç (ohm)
+  static constexpr float R2 = 4700.0f;            // Üst direnç (ohm)
+  static constexpr float ADC_MAX = 4095.0f;       // 12-bit ADC maksimum değeri
+  static constexpr float ESP32_VREF = 3.3f;       // ESP32 referans voltajı
+
+  // Şamandra kalibrasyonu (bu değerleri yakıt tankınıza göre ayarlayın)
+  static constexpr float FUEL_EMPTY_RESISTANCE = 10.0f;    // Boş tank direnci (ohm)
+  static constexpr float FUEL_FULL_RESISTANCE = 180.0f;    // Dolu tank direnci (ohm)
+
+  // Şamandra arka planda donanım zamanlayıcısıyla örneklenir; okuma tarafı
+  // yalnızca hazır filtre çıktısını alır. Ham örnekler halkada tutulur, son
+  // YAKIT_MEDYAN_PENCERESI örneğin medyanı sıçramaları atar, ardından birinci
+  // dereceden IIR (alfa = 1/2^YAKIT_IIR_KAYDIRMA) seviyeyi yumuşatır.
+  static const uint32_t YAKIT_ORNEK_ARALIGI_US = 20000;   // 50 Hz
+  static const uint8_t YAKIT_HALKA_BOYUTU = 8;
+  static const uint8_t YAKIT_MEDYAN_PENCERESI = 5;
+  static const uint8_t YAKIT_IIR_KAYDIRMA = 3;
+  static const uint8_t YAKIT_IIR_KESIR = 4;                // Filtre durumu ham x 16
+
+  esp_timer_handle_t zamanlayici;
+  uint16_t halka[YAKIT_HALKA_BOYUTU];
+  uint8_t halkaIndeks;
+  uint8_t halkaAdet;
+  uint32_t filtre;
+  std::atomic<float> seviye;
+  std::atomic<uint32_t> ornekSayisi;
+
+  void sample();
+  static void onSample(void* arg);
+  static float calculateFuelLevel(float adcVoltage);
+  static float resistanceToFuelLevel(float resistance);
+};
+
+#endif // D300_YAKIT_SENSORU_H
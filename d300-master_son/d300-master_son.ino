@@ -1,7 +1,8 @@
 #include <WiFi.h>
 #include <HTTPClient.h>
-#include <ArduinoJson.h>
+#include <Preferences.h>
 #include "D300Controller.h"
+#include "D300Telemetri.h"
 #include <WebSocketsServer.h>
 //gen'e bağlanacak nihai program ancak sadece şuan veri gönderme yapılabiliyor.
 //.net'den veri alma kısmı şuan çalışmıyor.
@@ -11,6 +12,7 @@
 const char* ssid = "Xiaomi12";
 const char* password = "genc4326";
 String serverUrl = "http://10.82.134.173:5156/api/generator/add"; 
+String batchServerUrl = "http://10.82.134.173:5156/api/generator/addBatch";
 WebSocketsServer webSocket = WebSocketsServer(81); // WebSocket sunucu portu
 
 // D-300 MK3 kontrol nesnesi
@@ -24,8 +26,25 @@ const unsigned long CHECK_INTERVAL = 1000; // 1 saniyede bir kontrol
 const int HTTP_TIMEOUT = 10000;
 const int MAX_RETRY_COUNT = 3;
 
+const unsigned long HEARTBEAT_INTERVAL = 60000; // Değişim olmasa da dakikada bir gönder
+const bool BINARY_UPLINK = true;                // false: JSON (api/generator/add)
+const uint16_t TELEMETRY_KEYFRAME_INTERVAL = 60; // Her 60 çerçevede bir tam çerçeve, arada delta
+// İkili modda örnekler RAM'de biriktirilip tek istekte gönderilir: 10 sn ya da 10 örnek, hangisi önce dolarsa
+const unsigned long BATCH_INTERVAL = 10000;
+const uint16_t BATCH_MAX_SAMPLES = 10;
+const uint16_t TELEMETRY_BUFFER_SIZE = 120;     // Bağlantı yokken ~2 dakikalık örnek tutulur
+const uint32_t SEQUENCE_RESERVE = 3600;         // Sıra numarası NVS'ye bu kadar ileriden (saatte bir) yazılır
+
 unsigned long lastPostTime = 0;
 unsigned long lastCheckTime = 0;
+unsigned long lastSentTime = 0;
+unsigned long lastFlushTime = 0;
+bool lastFlushOk = true;
+uint32_t lastSentGeneration = 0;   // Sunucuya yazılan (ikili modda kuyruğa alınan) son değişim nesli
+uint32_t telemetrySequence = 0;    // İkili çerçeve sıra numarası; sunucu tekrarları bununla ayıklar
+uint32_t sequenceReserved = 0;     // NVS'deki ayrılmış üst sınır
+D300Telemetri::DeltaKodlayici telemetryEncoder(TELEMETRY_KEYFRAME_INTERVAL);
+D300Telemetri::OrnekHalkasi<TELEMETRY_BUFFER_SIZE> telemetryBuffer;
 bool wifiConnected = false;
 
 void setup() {
@@ -42,18 +61,33 @@ void setup() {
   
   // D-300 MK3 bağlantısını başlat
   Serial.println("Jeneratöre bağlanılıyor...");
+  genset.onAlarmEvent(alarmOlayi);
   
-  if (genset.begin(9600, 3000)) {
+  // 250 ms slot: elektrik 250 ms, motor 1 sn, durum her slot, sayaçlar 60 sn
+  // Hat hızı otomatik bulunur ve kaydedilir; cihazdaki baud ayarı değişirse yeniden taranır
+  if (genset.begin(D300Controller::BAUD_OTOMATIK, 250)) {
     Serial.println("✅ D-300 MK3 bağlantısı başarılı!");
+    Serial.printf("Hat hızı: %lu baud\n", (unsigned long)genset.getBaudRate());
     Serial.println("Cihaz Kimlik: 0x" + String(genset.Sistem.CihazKimlik, HEX));
     
     // Otomatik güncellemeyi etkinleştir
     genset.enableAutoUpdate(true);
     
+    // 20 harmonik kanalı saniyede bir kanal taranır (tam tur ~20 sn)
+    genset.setHarmonicSweep(true);
+    
     Serial.println("Sistem başlatıldı. API veri gönderimi başlıyor...\n");
   } else {
     Serial.println("❌ D-300 MK3 bağlantı hatası!");
   }
+  
+  // Modbus edinimi çekirdek 0'daki görevde; loop() (çekirdek 1) ağ işlerine kalır
+  if (!genset.startTask(0)) {
+    Serial.println("⚠️ Edinim görevi başlatılamadı, okuma loop() içinde yapılacak");
+  }
+
+  // Sıra numarası yeniden başlatmada geri gitmemeli; sunucu kayıtlı sıraya kadar olanları atlar
+  reserveTelemetrySequence();
 
   webSocket.begin();
   webSocket.onEvent(webSocketEvent);
@@ -82,18 +116,26 @@ void setup() {
       lastCheckTime = currentTime;
     }
     
-    // API veri gönderimi
+    // API veri gönderimi; ikili modda örnek kuyruğa alınır, WiFi yokken de biriktirilir
     if (currentTime - lastPostTime >= POST_INTERVAL) {
-      if (wifiConnected && genset.isConnected()) {
-        sendGeneratorData();
+      if ((wifiConnected || BINARY_UPLINK) && genset.isConnected()) {
+        // Ölü bandı aşan değişim yoksa sunucuya tekrar yazılmaz
+        if (genset.getDegisimNesli() != lastSentGeneration ||
+            currentTime - lastSentTime >= HEARTBEAT_INTERVAL) {
+          sendGeneratorData();
+        }
       } else {
         Serial.println("⚠️ Veri gönderilemiyor: " + 
-          String(!wifiConnected ? "WiFi yok" : "Jeneratör bağlantısı yok"));
+          String(!genset.isConnected() ? "Jeneratör bağlantısı yok" : "WiFi yok"));
       }
       lastPostTime = currentTime;
     }
+    if (BINARY_UPLINK && wifiConnected) {
+      flushTelemetry(currentTime);
+    }
     webSocket.loop();
-    delay(100);
+    bildirKomutOnayi();
+    delay(2);   // Modbus cevapları genset.handle() içinde sonraki turlarda toplanır
   }
 
 void connectToWiFi() {
@@ -137,99 +179,157 @@ void performSystemCheck() {
   }
 }
 
+// Alarm bitleri değiştiğinde çağrılır
+void alarmOlayi(const AlarmOlayi &olay) {
+  const char* tip = olay.tip == AlarmTipi::Kapatma ? "KAPATMA" :
+                    olay.tip == AlarmTipi::YukAtma ? "YÜK ATMA" : "UYARI";
+  Serial.printf("%s Alarm #%u (%s) %s - %lu ms\n", olay.aktif ? "🚨" : "✅",
+                olay.bit, tip, olay.aktif ? "AKTİF" : "KALKTI", olay.zaman);
+}
+
 void sendGeneratorData() {
+  // Bayat veri sunucuya tekrar yazılmaz; değer korunmuş olsa da güncel değildir
+  if (genset.getAlanKalitesi(10246) != AlanKalitesi::Iyi) {
+    Serial.println("⚠️ Jeneratör verileri güncel değil, gönderim atlandı");
+    return;
+  }
   
-  String json = buildRealJson();
+  uint32_t generation = genset.getDegisimNesli();
   
-  bool success = httpPostSafe(json);
+  if (BINARY_UPLINK) {
+    // Örnek kuyruğa alınır; flushTelemetry() toplu gönderir
+    D300Telemetri::Ornek ornek;
+    if (!D300Telemetri::ornekAl(genset, ornek)) {
+      Serial.println("❌ Telemetri örneği alınamadı");
+      return;
+    }
+    auto& kayit = telemetryBuffer.ekle();
+    kayit.ornek = ornek;
+    if (telemetrySequence >= sequenceReserved) {
+      reserveTelemetrySequence();
+    }
+    kayit.sira = telemetrySequence++;
+    kayit.zaman = millis();
+    lastSentGeneration = generation;
+    lastSentTime = millis();
+    return;
+  }
+
+  static char json[1024];
+  size_t uzunluk = buildRealJson(json, sizeof(json));
+  if (uzunluk == 0) {
+    Serial.println("❌ JSON tampona sığmadı");
+    return;
+  }
   
-  if (success) {
+  if (httpPostSafe(serverUrl, "application/json", (const uint8_t*)json, uzunluk, nullptr)) {
+    lastSentGeneration = generation;
+    lastSentTime = millis();
     Serial.println("✅ Veri başarıyla gönderildi");
   } else {
     Serial.println("❌ Veri gönderilemedi");
   }
 }
 
-String buildRealJson() {
-  // D-300'den güncel verileri al
-  genset.updateBasicData();
-  
-  StaticJsonDocument<1024> doc; // JSON boyutunu artırdık
-  
-  // Temel durum bilgileri
-  doc["CalismaDurumu"] = genset.getDurumAciklama();
-  doc["OperationMode"] = static_cast<int>(genset.getUniteModu());
-  doc["SistemCalismaSuresi"] = genset.Sayac.MotorCalismaSaati * 3600; // Saati saniyeye çevir
-  
-  // Şebeke verileri
-  doc["SebekeVoltaj_l1"] = genset.ElektrikSistemi.Sebeke.L1.Voltaj;
-  doc["SebekeVoltaj_l2"] = genset.ElektrikSistemi.Sebeke.L2.Voltaj;
-  doc["SebekeVoltaj_l3"] = genset.ElektrikSistemi.Sebeke.L3.Voltaj;
-  doc["SebekeHz"] = genset.getSebekeFrekans();
-  doc["ToplamGuc"] = genset.ElektrikSistemi.Sebeke.Toplam.AktifGuc * 1000; // kW'tan W'a çevir
-  doc["SebekeDurumu"] = genset.isSebekeMevcut();
-  
-  // Jeneratör verileri
-  doc["GenVoltaj_l1"] = genset.ElektrikSistemi.Jenerator.L1.Voltaj;
-  doc["GenVoltaj_l2"] = genset.ElektrikSistemi.Jenerator.L2.Voltaj;
-  doc["GenVoltaj_l3"] = genset.ElektrikSistemi.Jenerator.L3.Voltaj;
-  doc["GenHz"] = genset.getJeneratorFrekans();
-  doc["GenUretilenGuc"] = genset.getJeneratorGuc() * 1000; // kW'tan W'a çevir
-  
-  // Güç faktörü hesaplama
-  float gorunurGuc = sqrt(pow(genset.ElektrikSistemi.Jenerator.Toplam.AktifGuc, 2) + 
-                         pow(genset.ElektrikSistemi.Jenerator.Toplam.ReaktifGuc, 2));
-  float gucFaktoru = (gorunurGuc > 0) ? (genset.ElektrikSistemi.Jenerator.Toplam.AktifGuc / gorunurGuc) * 100 : 0;
-  doc["GenGucFaktoru"] = gucFaktoru;
-  
-  // Motor verileri
-  doc["MotorRpm"] = genset.getMotorRPM();
-  doc["MotorSicaklik"] = genset.Motor.Sicaklik;
-  doc["YagBasinci"] = genset.Motor.YagBasinci;
-  doc["YakitSeviyesi"] = genset.getYakitSeviyesi();
-  doc["BataryaVoltaji"] = genset.getBataryaVoltaji();
-  doc["timestamp"] = millis();
-  
-  // Alarm durumu (opsiyonel - API'de ihtiyaç varsa)
-  doc["KapatmaAlarmi"] = genset.isAlarmActive(AlarmTipi::Kapatma);
-  doc["YukAtmaAlarmi"] = genset.isAlarmActive(AlarmTipi::YukAtma);
-  doc["UyariAlarmi"] = genset.isAlarmActive(AlarmTipi::Uyari);
-  doc["SistemSaglikli"] = genset.isSystemHealthy();
-  
-  String jsonString;
-  serializeJson(doc, jsonString);
-  
-  // Debug için JSON'u yazdır
-  //Serial.println("📄 Gönderilen JSON:");
-  //Serial.println(jsonString);
-  
-  return jsonString;
+// Açılışta kaldığı yerden (son ayrılan sınırdan) başlar ve SEQUENCE_RESERVE kadar ileriyi
+// ayırır; NVS'ye açılışta ve saatte bir yazılır, kullanılmayan aralık atlanır
+void reserveTelemetrySequence() {
+  Preferences nvs;
+  nvs.begin("telemetri", false);
+  if (sequenceReserved == 0) {
+    telemetrySequence = nvs.getUInt("sira", 0);
+  }
+  sequenceReserved = telemetrySequence + SEQUENCE_RESERVE;
+  nvs.putUInt("sira", sequenceReserved);
+  nvs.end();
 }
 
-bool httpPostSafe(const String &payload) {
+// Kuyruktaki örnekleri art arda çerçeveler olarak tek istekte gönderir (api/generator/addBatch).
+// İlk çerçeve onaylı son çerçeveye, sonrakiler bir öncekine göre delta yazılır.
+void flushTelemetry(unsigned long simdi) {
+  uint16_t adet = telemetryBuffer.boyut();
+  if (adet == 0) return;
+  // Dolu toplu hemen gider; başarısız denemeden sonra aralık beklenir
+  if (simdi - lastFlushTime < BATCH_INTERVAL && (adet < BATCH_MAX_SAMPLES || !lastFlushOk)) return;
+  lastFlushTime = simdi;
+  if (adet > BATCH_MAX_SAMPLES) adet = BATCH_MAX_SAMPLES;
+
+  static uint8_t toplu[BATCH_MAX_SAMPLES * D300Telemetri::MAX_CERCEVE_BOYUTU];
+  uint32_t cihazKimligi = (uint32_t)ESP.getEfuseMac();
+  size_t uzunluk = 0;
+  telemetryEncoder.zincirBasla();
+  for (uint16_t i = 0; i < adet; i++) {
+    const auto& kayit = telemetryBuffer[i];
+    size_t n = telemetryEncoder.cerceveYaz(kayit.ornek, toplu + uzunluk, sizeof(toplu) - uzunluk,
+                                           cihazKimligi, kayit.sira, kayit.zaman);
+    if (n == 0) {
+      adet = i;
+      break;
+    }
+    uzunluk += n;
+  }
+  if (adet == 0) {
+    Serial.println("❌ Telemetri çerçevesi tampona sığmadı, örnek atlandı");
+    telemetryBuffer.dusur(1);
+    return;
+  }
+
+  int httpKodu = 0;
+  lastFlushOk = httpPostSafe(batchServerUrl, "application/octet-stream", toplu, uzunluk, &httpKodu);
+  if (lastFlushOk) {
+    telemetryEncoder.onayla(telemetryBuffer[adet - 1].sira);
+    telemetryBuffer.dusur(adet);
+    Serial.printf("✅ %u örnek gönderildi (%u bayt)\n", adet, (unsigned)uzunluk);
+  } else if (httpKodu == 409) {
+    // Sunucu delta tabanını tanımıyor (yeniden başlatma vb.); sonraki toplu tam çerçeveyle başlar
+    telemetryEncoder.sifirla();
+    Serial.printf("❌ Delta tabanı reddedildi, %u örnek tam çerçeveyle yeniden denenecek\n", telemetryBuffer.boyut());
+  } else if (httpKodu >= 400 && httpKodu < 500) {
+    // Kalıcı ret (geçersiz toplu, 413 vb.): aynı toplu her denemede reddedilir ve
+    // kuyruğu tıkar. Atılır; sonraki toplu tam çerçeveyle başlar.
+    telemetryBuffer.dusur(adet);
+    telemetryEncoder.sifirla();
+    Serial.printf("❌ Toplu sunucu tarafından reddedildi (HTTP %d), %u örnek atıldı\n", httpKodu, adet);
+  } else {
+    // Ağ hatası ya da 5xx: aynı toplu sonra yeniden denenir
+    Serial.printf("❌ Toplu gönderim başarısız, %u örnek kuyrukta\n", telemetryBuffer.boyut());
+  }
+}
+
+// Web API alanları kütüphanedeki şemadan (D300Sema::WebApi) sabit tampona yazılır;
+// ara JSON belgesi ve heap kullanılmaz. Taşarsa 0 döner.
+size_t buildRealJson(char* tampon, size_t boyut) {
+  JsonYazici yazici(tampon, boyut);
+  genset.writeJson(yazici);
+  return yazici.tasti() ? 0 : yazici.bitir();
+}
+
+bool httpPostSafe(const String &url, const char* icerikTipi, const uint8_t* payload, size_t uzunluk, int* httpKodu) {
   if (WiFi.status() != WL_CONNECTED) {
     Serial.println("❌ WiFi bağlı değil, POST atılmadı.");
     return false;
   }
 
-  HTTPClient http;
-  WiFiClient client;
+  // Bağlantı çağrılar arasında açık tutulur (keep-alive); her gönderimde TCP el sıkışması yapılmaz
+  static WiFiClient client;
+  static HTTPClient http;
+  http.setReuse(true);
   http.setTimeout(HTTP_TIMEOUT);
   bool success = false;
 
-  if (!http.begin(client, serverUrl)) {
+  if (!http.begin(client, url)) {
     Serial.println("❌ http.begin() başarısız!");
     return false;
   }
 
-  http.addHeader("Content-Type", "application/json");
+  http.addHeader("Content-Type", icerikTipi);
   http.addHeader("User-Agent", "ESP32-D300-Generator");
 
   int retry = 0;
   while (retry < MAX_RETRY_COUNT) {
-    //Serial.printf("🔄 POST denemesi %d, payload length=%u\n", retry+1, payload.length());
+    //Serial.printf("🔄 POST denemesi %d, payload length=%u\n", retry+1, uzunluk);
     
-    int httpCode = http.POST(payload);
+    int httpCode = http.POST((uint8_t*)payload, uzunluk);
     
     if (httpCode > 0) {
       //Serial.printf("📨 HTTP cevap kodu: %d\n", httpCode);
@@ -237,6 +337,7 @@ bool httpPostSafe(const String &payload) {
       //Serial.println("📨 Sunucu cevabı: " + response);
       
       success = (httpCode >= 200 && httpCode < 300);
+      if (httpKodu != nullptr) *httpKodu = httpCode;
       break;
     } else {
       Serial.printf("❌ HTTP POST hatası: %d -> %s\n", httpCode, http.errorToString(httpCode).c_str());
@@ -265,27 +366,60 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
   }
 }
 
+// Onay sonucu edinim görevinden gelir; kuyrukla loop()'a taşınır ve WebSocket'e
+// oradan yazılır. Art arda gelen sonuçlar (ör. iptal edilen buton + acil stop) kaybolmaz.
+struct OnayMesaji {
+  KomutOnayi onay;
+  const char* ad;
+};
+const UBaseType_t ONAY_KUYRUGU_BOYUTU = 8;
+QueueHandle_t onayKuyrugu = xQueueCreate(ONAY_KUYRUGU_BOYUTU, sizeof(OnayMesaji));
+
+void komutOnayi(void* baglam, const KomutOnayi &onay) {
+  OnayMesaji mesaj = { onay, static_cast<const char*>(baglam) };
+  if (onayKuyrugu == nullptr || xQueueSend(onayKuyrugu, &mesaj, 0) != pdTRUE) {
+    Serial.printf("⚠️ Komut onayı kuyruğu dolu, %s sonucu atıldı\n", mesaj.ad);
+  }
+}
+
+void bildirKomutOnayi() {
+  if (onayKuyrugu == nullptr) return;
+  OnayMesaji m;
+  while (xQueueReceive(onayKuyrugu, &m, 0) == pdTRUE) {
+    yayinlaKomutOnayi(m.onay, m.ad);
+  }
+}
+
+void yayinlaKomutOnayi(const KomutOnayi &onay, const char* ad) {
+  const char* sonuc = onay.sonuc == OnaySonucu::Onaylandi ? "confirmed" :
+                      onay.sonuc == OnaySonucu::ZamanAsimi ? "timeout" :
+                      onay.sonuc == OnaySonucu::YazmaHatasi ? "write_error" : "cancelled";
+  unsigned long sure = onay.yazmaZamani ? onay.onayZamani - onay.yazmaZamani : 0;   // Yazılmadıysa 0
+  String mesaj = "{\"command\":\"" + String(ad) + "\",\"result\":\"" + sonuc +
+                 "\",\"status\":" + String(static_cast<int>(onay.yeniDurum)) +
+                 ",\"mode\":" + String(static_cast<int>(onay.yeniMod)) +
+                 ",\"at\":" + String(onay.onayZamani) +
+                 ",\"ms\":" + String(sure) + "}";
+  webSocket.broadcastTXT(mesaj);
+  Serial.printf("%s %s komutu: %s - %lu ms, %u okuma\n", onay.sonuc == OnaySonucu::Onaylandi ? "✅" : "❌",
+                ad, sonuc, sure, onay.okumaSayisi);
+}
+
 void start_gen() {
-  genset.startGenerator();
-  Serial.println("başlama moduna geçildi!");
+  if (genset.simulateButtonConfirmed(ButonMaski::AUTO, komutOnayi, (void*)"start")) Serial.println("başlama komutu kuyrukta");
 }
 void stop_gen() {
-  genset.stopGenerator();
-  Serial.println("durdurma moduna geçildi!");
+  if (genset.simulateButtonConfirmed(ButonMaski::STOP, komutOnayi, (void*)"stop")) Serial.println("durdurma komutu kuyrukta");
 }
 void auto_gen(){
-  genset.setAutoMode();
-  Serial.println("auto mod geçildi!");
+  if (genset.simulateButtonConfirmed(ButonMaski::AUTO, komutOnayi, (void*)"auto")) Serial.println("auto komutu kuyrukta");
 }
 void manuel_gen(){
-  genset.setManualMode();
-  Serial.println("manuel mod geçildi!");
+  if (genset.simulateButtonConfirmed(ButonMaski::MANUEL_RUN, komutOnayi, (void*)"manuel")) Serial.println("manuel komutu kuyrukta");
 }
 void test_gen(){
-  genset.setTestMode();
-  Serial.println("test mod geçildi!");
+  if (genset.simulateButtonConfirmed(ButonMaski::TEST, komutOnayi, (void*)"test")) Serial.println("test komutu kuyrukta");
 }
 void acilstop_gen(){
-  genset.emergencyStop();
-  Serial.println("acilstop moduna geçildi!");
+  if (genset.emergencyStopConfirmed(komutOnayi, (void*)"emergency")) Serial.println("acil stop komutu kuyrukta");
 }
\ No newline at end of file
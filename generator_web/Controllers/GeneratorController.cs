@@ -2,6 +2,7 @@
 using Microsoft.AspNetCore.Authorization;
 using Microsoft.AspNetCore.Identity;
 using Microsoft.AspNetCore.Mvc;
+using System.Buffers;
 using System.Security.Claims;
 
 
@@ -15,11 +16,14 @@ namespace generator_web.Controllers
         private readonly AppDbContext _context;
         private readonly IHttpClientFactory _httpClientFactory;
         private readonly string _espBaseUrl;
+        private readonly TelemetryStateCache _telemetryStates;
 
-        public GeneratorController(AppDbContext context,IHttpClientFactory httpClientFactory, IConfiguration configuration)
+        public GeneratorController(AppDbContext context,IHttpClientFactory httpClientFactory, IConfiguration configuration,
+                                   TelemetryStateCache telemetryStates)
         {
             _context = context;
             _httpClientFactory = httpClientFactory;
+            _telemetryStates = telemetryStates;
             _espBaseUrl = configuration.GetValue<string>("Esp:BaseUrl") ?? "http://10.82.134.241:5156";
         }
 
@@ -57,6 +61,173 @@ namespace generator_web.Controllers
             }
         }
 
+        // İkili telemetri çerçevesi (Models/TelemetryFrame.cs); JSON model bağlama yerine span üzerinden çözülür.
+        // Delta çerçevenin tabanı bilinmiyorsa 409 döner, cihaz sonraki çerçeveyi tam gönderir.
+        [HttpPost("addBinary")]
+        [AllowAnonymous]
+        [Consumes("application/octet-stream")]
+        public async Task<IActionResult> AddBinary()
+        {
+            long? length = Request.ContentLength;
+            if (length == null || length < TelemetryFrameDecoder.MinFrameSize || length > TelemetryFrameDecoder.MaxFrameSize)
+                return BadRequest("Geçersiz çerçeve uzunluğu");
+
+            byte[] buffer = ArrayPool<byte>.Shared.Rent((int)length.Value);
+            try
+            {
+                int read = await ReadBodyAsync(buffer, (int)length.Value);
+
+                var result = TelemetryFrameDecoder.TryDecode(buffer.AsSpan(0, read), _telemetryStates,
+                                                             out var header, out var sample, out var error);
+                if (result == TelemetryDecodeResult.MissingBase)
+                    return Conflict(new { message = "Delta tabanı bulunamadı, tam çerçeve gönderin", error });
+                if (result != TelemetryDecodeResult.Ok)
+                    return BadRequest(new { message = "Çerçeve çözülemedi", error });
+
+                // Yanıtı kaybolup tekrar gönderilen çerçeve yeniden yazılmaz
+                if (_telemetryStates.IsStored(header.DeviceId, header.Sequence))
+                {
+                    return Ok(new
+                    {
+                        message = "Çerçeve zaten kayıtlı",
+                        deviceId = header.DeviceId,
+                        sequence = header.Sequence,
+                        duplicate = true
+                    });
+                }
+
+                var data = TelemetryFrameDecoder.ToGeneratorData(sample, header);
+                _context.generator_datas.Add(data);
+                await _context.SaveChangesAsync();
+
+                // Yalnızca kaydedilen çerçeve sonraki deltalara taban olur
+                _telemetryStates.Store(header.DeviceId, header.Sequence, sample);
+
+                return Ok(new
+                {
+                    message = "Veri başarıyla eklendi",
+                    deviceId = header.DeviceId,
+                    sequence = header.Sequence,
+                    timestamp = data.timestamp
+                });
+            }
+            catch (Exception ex)
+            {
+                return StatusCode(500, new
+                {
+                    message = "Veri eklenirken hata oluştu",
+                    error = ex.Message
+                });
+            }
+            finally
+            {
+                ArrayPool<byte>.Shared.Return(buffer);
+            }
+        }
+
+        // Cihazın RAM'de biriktirdiği örnekler: art arda ikili çerçeveler, tek SaveChanges ile yazılır
+        [HttpPost("addBatch")]
+        [AllowAnonymous]
+        [Consumes("application/octet-stream")]
+        public async Task<IActionResult> AddBatch()
+        {
+            long? length = Request.ContentLength;
+            if (length == null || length < TelemetryFrameDecoder.MinFrameSize || length > TelemetryFrameDecoder.MaxBatchSize)
+                return BadRequest("Geçersiz topluluk uzunluğu");
+
+            byte[] buffer = ArrayPool<byte>.Shared.Rent((int)length.Value);
+            try
+            {
+                int read = await ReadBodyAsync(buffer, (int)length.Value);
+
+                var frames = new List<(TelemetryFrameHeader Header, TelemetrySample Sample)>();
+                var result = TelemetryFrameDecoder.TryDecodeBatch(buffer.AsSpan(0, read), _telemetryStates, frames, out var error);
+                if (result == TelemetryDecodeResult.MissingBase)
+                    return Conflict(new { message = "Delta tabanı bulunamadı, tam çerçeve gönderin", error });
+                if (result != TelemetryDecodeResult.Ok)
+                    return BadRequest(new { message = "Topluluk çözülemedi", error });
+
+                // Yanıtı kaybolup tekrar gönderilen topluluğun kayıtlı çerçeveleri atlanır;
+                // cihaz yine onay alır ve kuyruğunu boşaltır
+                var fresh = frames.Where(f => !_telemetryStates.IsStored(f.Header.DeviceId, f.Header.Sequence)).ToList();
+                var last = frames[^1];
+                if (fresh.Count > 0)
+                {
+                    _context.generator_datas.AddRange(fresh.Select(f => TelemetryFrameDecoder.ToGeneratorData(f.Sample, f.Header)));
+                    await _context.SaveChangesAsync();
+
+                    // Topluluk içindeki deltalar birbirine dayanır; sonraki topluluğun tabanı son çerçevedir
+                    _telemetryStates.Store(last.Header.DeviceId, last.Header.Sequence, last.Sample);
+                }
+
+                return Ok(new
+                {
+                    message = "Veriler başarıyla eklendi",
+                    count = fresh.Count,
+                    duplicates = frames.Count - fresh.Count,
+                    deviceId = last.Header.DeviceId,
+                    lastSequence = last.Header.Sequence
+                });
+            }
+            catch (Exception ex)
+            {
+                return StatusCode(500, new
+                {
+                    message = "Veri eklenirken hata oluştu",
+                    error = ex.Message
+                });
+            }
+            finally
+            {
+                ArrayPool<byte>.Shared.Return(buffer);
+            }
+        }
+
+        // Aynı toplu ekleme JSON dizisiyle (api/generator/add gövdesinin dizisi)
+        [HttpPost("addBatch")]
+        [AllowAnonymous]
+        [Consumes("application/json")]
+        public async Task<IActionResult> AddBatchJson([FromBody] List<generator_data> data)
+        {
+            try
+            {
+                if (data == null || data.Count == 0)
+                    return BadRequest("Veri boş olamaz");
+                if (data.Count > TelemetryFrameDecoder.MaxBatchFrames)
+                    return BadRequest($"Toplulukta en fazla {TelemetryFrameDecoder.MaxBatchFrames} kayıt olabilir");
+
+                _context.generator_datas.AddRange(data);
+                await _context.SaveChangesAsync();
+
+                return Ok(new
+                {
+                    message = "Veriler başarıyla eklendi",
+                    count = data.Count
+                });
+            }
+            catch (Exception ex)
+            {
+                return StatusCode(500, new
+                {
+                    message = "Veri eklenirken hata oluştu",
+                    error = ex.Message
+                });
+            }
+        }
+
+        private async Task<int> ReadBodyAsync(byte[] buffer, int length)
+        {
+            int read = 0;
+            while (read < length)
+            {
+                int n = await Request.Body.ReadAsync(buffer.AsMemory(read, length - read));
+                if (n == 0)
+                    break;
+                read += n;
+            }
+            return read;
+        }
+
         [HttpGet]
         public async Task<IActionResult> GetAll()
         {
@@ -0,0 +1,481 @@
+﻿using System.Buffers.Binary;
+using System.Collections.Concurrent;
+
+namespace generator_web.Models
+{
+    // ESP32'nin gönderdiği ikili telemetri çerçevesinin başlığı
+    public readonly struct TelemetryFrameHeader
+    {
+        public byte SchemaVersion { get; init; }
+        public byte FrameType { get; init; }
+        public uint DeviceId { get; init; }
+        public uint Sequence { get; init; }
+        public uint Timestamp { get; init; }
+    }
+
+    // Çerçevedeki ham değerler (int32 sabit nokta + bayraklar); delta çerçeveler bunun üzerine kurulur
+    public sealed class TelemetrySample
+    {
+        public TelemetrySample(int[] values, byte flags)
+        {
+            Values = values;
+            Flags = flags;
+        }
+
+        public int[] Values { get; }
+        public byte Flags { get; }
+    }
+
+    public enum TelemetryDecodeResult
+    {
+        Ok,
+        Invalid,
+        MissingBase
+    }
+
+    // İkili çerçeve çözücü. Düzen firmware'deki d300-master_son/D300Telemetri.h ile aynıdır:
+    // 18 bayt başlık, yük, CRC-16/MODBUS. Tam yük int32 sabit nokta değerler + bayrak baytıdır;
+    // delta yük, cihazın onaylanmış önceki bir çerçevesine göre yalnızca değişen değerleri taşır.
+    // Tüm alanlar little-endian; çözüm ara kopya ve yansıma (reflection) kullanmaz.
+    public static class TelemetryFrameDecoder
+    {
+        public const int HeaderSize = 18;
+        public const int CrcSize = 2;
+        public const int MaxFrameSize = 512;
+        public const int MinFrameSize = HeaderSize + CrcSize;
+
+        // Toplu gönderim: art arda çerçeveler (api/generator/addBatch)
+        public const int MaxBatchFrames = 64;
+        public const int MaxBatchSize = MaxBatchFrames * MaxFrameSize;
+
+        public const byte SchemaVersion = 1;
+        public const byte FrameTypeFull = 0;
+        public const byte FrameTypeDelta = 1;
+
+        // Firmware sonlu olmayan / okunamayan değerleri bu işaretle gönderir
+        private const int MissingValue = int.MinValue;
+
+        // Sürüm 1: 19 sayı + 1 bayrak baytı
+        private const int Version1ValueCount = 19;
+        private const int Version1PayloadSize = Version1ValueCount * 4 + 1;
+        private const int Version1BitmapSize = (Version1ValueCount + 7) / 8;
+
+        // Tam ya da delta çerçeveyi çözer; delta tabanı states'ten alınır. Kayıt sonrası
+        // çağıranın örneği states.Store ile saklaması gerekir ki sonraki deltalar çözülebilsin.
+        public static TelemetryDecodeResult TryDecode(ReadOnlySpan<byte> frame, TelemetryStateCache states,
+                                                      out TelemetryFrameHeader header, out TelemetrySample sample,
+                                                      out string? error)
+        {
+            return TryDecode(frame, states, null, out header, out sample, out error);
+        }
+
+        // Art arda çerçevelerden oluşan toplu gövdeyi çözer. Delta tabanı önce aynı toplulukta
+        // önceki çerçevelerde, sonra states'te aranır. Bir çerçeve bile çözülemezse topluluk reddedilir.
+        public static TelemetryDecodeResult TryDecodeBatch(ReadOnlySpan<byte> body, TelemetryStateCache states,
+                                                           List<(TelemetryFrameHeader Header, TelemetrySample Sample)> frames,
+                                                           out string? error)
+        {
+            frames.Clear();
+            int offset = 0;
+            while (offset < body.Length)
+            {
+                if (frames.Count == MaxBatchFrames)
+                {
+                    error = $"Toplulukta en fazla {MaxBatchFrames} çerçeve olabilir";
+                    return TelemetryDecodeResult.Invalid;
+                }
+                if (body.Length - offset < HeaderSize)
+                {
+                    error = $"Çerçeve {frames.Count} eksik";
+                    return TelemetryDecodeResult.Invalid;
+                }
+
+                int frameLength = HeaderSize + BinaryPrimitives.ReadUInt16LittleEndian(body.Slice(offset + 16, 2)) + CrcSize;
+                if (frameLength > body.Length - offset)
+                {
+                    error = $"Çerçeve {frames.Count} eksik";
+                    return TelemetryDecodeResult.Invalid;
+                }
+
+                var result = TryDecode(body.Slice(offset, frameLength), states, frames,
+                                       out var header, out var sample, out error);
+                if (result != TelemetryDecodeResult.Ok)
+                {
+                    error = $"Çerçeve {frames.Count}: {error}";
+                    return result;
+                }
+
+                frames.Add((header, sample));
+                offset += frameLength;
+            }
+
+            if (frames.Count == 0)
+            {
+                error = "Boş topluluk";
+                return TelemetryDecodeResult.Invalid;
+            }
+            error = null;
+            return TelemetryDecodeResult.Ok;
+        }
+
+        private static TelemetryDecodeResult TryDecode(ReadOnlySpan<byte> frame, TelemetryStateCache states,
+                                                       List<(TelemetryFrameHeader Header, TelemetrySample Sample)>? batch,
+                                                       out TelemetryFrameHeader header, out TelemetrySample sample,
+                                                       out string? error)
+        {
+            sample = null!;
+
+            if (!TryReadHeader(frame, out header, out var payload, out error))
+                return TelemetryDecodeResult.Invalid;
+
+            switch (header.FrameType)
+            {
+                case FrameTypeFull:
+                    return TryDecodeFull(payload, out sample, out error)
+                        ? TelemetryDecodeResult.Ok
+                        : TelemetryDecodeResult.Invalid;
+
+                case FrameTypeDelta:
+                    if (payload.Length < 4)
+                    {
+                        error = "Delta yükü taban sıra numarası içermiyor";
+                        return TelemetryDecodeResult.Invalid;
+                    }
+                    uint baseSequence = BinaryPrimitives.ReadUInt32LittleEndian(payload);
+                    if (!TryFindInBatch(batch, header.DeviceId, baseSequence, out var baseSample) &&
+                        !states.TryGet(header.DeviceId, baseSequence, out baseSample))
+                    {
+                        error = $"Taban çerçeve bulunamadı: {baseSequence}";
+                        return TelemetryDecodeResult.MissingBase;
+                    }
+                    return TryApplyDelta(payload, baseSample, out sample, out error)
+                        ? TelemetryDecodeResult.Ok
+                        : TelemetryDecodeResult.Invalid;
+
+                default:
+                    error = $"Desteklenmeyen çerçeve tipi: {header.FrameType}";
+                    return TelemetryDecodeResult.Invalid;
+            }
+        }
+
+        // İşaret, sürüm, uzunluk ve CRC'yi doğrular; yükü kopyalamadan döner
+        public static bool TryReadHeader(ReadOnlySpan<byte> frame, out TelemetryFrameHeader header,
+                                         out ReadOnlySpan<byte> payload, out string? error)
+        {
+            header = default;
+            payload = default;
+
+            if (frame.Length < MinFrameSize || frame.Length > MaxFrameSize)
+            {
+                error = $"Geçersiz çerçeve uzunluğu: {frame.Length}";
+                return false;
+            }
+            if (frame[0] != (byte)'D' || frame[1] != (byte)'3')
+            {
+                error = "Çerçeve işareti hatalı";
+                return false;
+            }
+            if (frame[2] != SchemaVersion)
+            {
+                error = $"Desteklenmeyen şema sürümü: {frame[2]}";
+                return false;
+            }
+
+            int payloadLength = BinaryPrimitives.ReadUInt16LittleEndian(frame.Slice(16, 2));
+            if (HeaderSize + payloadLength + CrcSize != frame.Length)
+            {
+                error = "Yük uzunluğu çerçeve boyutuyla uyuşmuyor";
+                return false;
+            }
+
+            var body = frame.Slice(0, HeaderSize + payloadLength);
+            ushort crc = BinaryPrimitives.ReadUInt16LittleEndian(frame.Slice(HeaderSize + payloadLength, CrcSize));
+            if (Crc16(body) != crc)
+            {
+                error = "CRC hatası";
+                return false;
+            }
+
+            header = new TelemetryFrameHeader
+            {
+                SchemaVersion = frame[2],
+                FrameType = frame[3],
+                DeviceId = BinaryPrimitives.ReadUInt32LittleEndian(frame.Slice(4, 4)),
+                Sequence = BinaryPrimitives.ReadUInt32LittleEndian(frame.Slice(8, 4)),
+                Timestamp = BinaryPrimitives.ReadUInt32LittleEndian(frame.Slice(12, 4))
+            };
+            payload = frame.Slice(HeaderSize, payloadLength);
+            error = null;
+            return true;
+        }
+
+        private static bool TryFindInBatch(List<(TelemetryFrameHeader Header, TelemetrySample Sample)>? batch,
+                                           uint deviceId, uint sequence, out TelemetrySample sample)
+        {
+            if (batch != null)
+            {
+                for (int i = batch.Count - 1; i >= 0; i--)
+                {
+                    if (batch[i].Header.DeviceId == deviceId && batch[i].Header.Sequence == sequence)
+                    {
+                        sample = batch[i].Sample;
+                        return true;
+                    }
+                }
+            }
+            sample = null!;
+            return false;
+        }
+
+        // Sürüm 1 tam yükü
+        public static bool TryDecodeFull(ReadOnlySpan<byte> payload, out TelemetrySample sample, out string? error)
+        {
+            sample = null!;
+            if (payload.Length != Version1PayloadSize)
+            {
+                error = $"Sürüm 1 yükü {Version1PayloadSize} bayt olmalı, gelen {payload.Length}";
+                return false;
+            }
+
+            var values = new int[Version1ValueCount];
+            for (int i = 0; i < values.Length; i++)
+                values[i] = BinaryPrimitives.ReadInt32LittleEndian(payload.Slice(i * 4, 4));
+
+            sample = new TelemetrySample(values, payload[Version1ValueCount * 4]);
+            error = null;
+            return true;
+        }
+
+        // Sürüm 1 delta yükü: taban sıra (4), değişim bit haritası, değişen her değer için
+        // zigzag varint fark, bayrak baytı
+        public static bool TryApplyDelta(ReadOnlySpan<byte> payload, TelemetrySample baseSample,
+                                         out TelemetrySample sample, out string? error)
+        {
+            sample = null!;
+            if (payload.Length < 4 + Version1BitmapSize + 1 || baseSample.Values.Length != Version1ValueCount)
+            {
+                error = "Delta yükü çok kısa";
+                return false;
+            }
+
+            var bitmap = payload.Slice(4, Version1BitmapSize);
+            var values = (int[])baseSample.Values.Clone();
+            int offset = 4 + Version1BitmapSize;
+
+            for (int i = 0; i < Version1ValueCount; i++)
+            {
+                if ((bitmap[i / 8] & (1 << (i % 8))) == 0)
+                    continue;
+
+                if (!TryReadVarint(payload, ref offset, out ulong encoded))
+                {
+                    error = $"Delta değeri {i} okunamadı";
+                    return false;
+                }
+
+                long delta = (long)(encoded >> 1) ^ -(long)(encoded & 1);
+                long value = values[i] + delta;
+                if (value < int.MinValue || value > int.MaxValue)
+                {
+                    error = $"Delta değeri {i} aralık dışında";
+                    return false;
+                }
+                values[i] = (int)value;
+            }
+
+            if (offset != payload.Length - 1)
+            {
+                error = "Delta yükü uzunluğu bit haritasıyla uyuşmuyor";
+                return false;
+            }
+
+            sample = new TelemetrySample(values, payload[offset]);
+            error = null;
+            return true;
+        }
+
+        // Sıra D300Telemetri::IkiliApi ile aynı
+        public static generator_data ToGeneratorData(TelemetrySample sample, TelemetryFrameHeader header)
+        {
+            var values = sample.Values;
+            byte flags = sample.Flags;
+
+            return new generator_data
+            {
+                CalismaDurumu = StatusText(Raw(values, 0)),
+                OperationMode = Raw(values, 1),
+                SistemCalismaSuresi = Raw(values, 2),
+                SebekeVoltaj_l1 = Fixed(values, 3, 1),
+                SebekeVoltaj_l2 = Fixed(values, 4, 1),
+                SebekeVoltaj_l3 = Fixed(values, 5, 1),
+                SebekeHz = Fixed(values, 6, 1),
+                ToplamGuc = Fixed(values, 7, 0),
+                GenVoltaj_l1 = Fixed(values, 8, 1),
+                GenVoltaj_l2 = Fixed(values, 9, 1),
+                GenVoltaj_l3 = Fixed(values, 10, 1),
+                GenHz = Fixed(values, 11, 1),
+                GenUretilenGuc = Fixed(values, 12, 0),
+                GenGucFaktoru = Fixed(values, 13, 1),
+                MotorRpm = Fixed(values, 14, 0),
+                MotorSicaklik = Fixed(values, 15, 1),
+                YagBasinci = Fixed(values, 16, 1),
+                YakitSeviyesi = Fixed(values, 17, 1),
+                BataryaVoltaji = Fixed(values, 18, 1),
+                SebekeDurumu = (flags & 0x01) != 0,
+                KapatmaAlarmi = (flags & 0x02) != 0,
+                YukAtmaAlarmi = (flags & 0x04) != 0,
+                UyariAlarmi = (flags & 0x08) != 0,
+                SistemSaglikli = (flags & 0x10) != 0,
+                timestamp = header.Timestamp
+            };
+        }
+
+        // 7 bitlik gruplar, düşük grup önce; en fazla 10 bayt
+        private static bool TryReadVarint(ReadOnlySpan<byte> data, ref int offset, out ulong value)
+        {
+            value = 0;
+            for (int shift = 0; shift < 70; shift += 7)
+            {
+                if (offset >= data.Length)
+                    return false;
+                byte b = data[offset++];
+                value |= (ulong)(b & 0x7F) << shift;
+                if ((b & 0x80) == 0)
+                    return true;
+            }
+            return false;
+        }
+
+        private static int Raw(int[] values, int index)
+        {
+            int value = values[index];
+            return value == MissingValue ? 0 : value;
+        }
+
+        private static float Fixed(int[] values, int index, int decimals)
+        {
+            int value = Raw(values, index);
+            return decimals switch
+            {
+                0 => value,
+                1 => value / 10f,
+                _ => value / MathF.Pow(10, decimals)
+            };
+        }
+
+        // Firmware'deki D300Controller::getDurumMetni ile aynı metinler
+        public static string StatusText(int status) => status switch
+        {
+            0 => "Jeneratör Dinlenme",
+            1 => "Yakıt Öncesi Bekleme",
+            2 => "Motor Ön Isıtma",
+            3 => "Yağ Flash Bekleme",
+            4 => "Marş Dinlenmesi",
+            5 => "Marş Atma",
+            6 => "Motor Rölanti Hızı",
+            7 => "Motor Isınması",
+            8 => "Yüksüz Çalışma",
+            9 => "Şebekeye Senkronizasyon",
+            10 => "Yük Transferi Jeneratöre",
+            13 => "Master Jeneratör Yüklü",
+            21 => "Soğutmalı Durdurma",
+            22 => "Soğuyor",
+            24 => "Acil Durdurma",
+            _ => $"Bilinmeyen ({status})"
+        };
+
+        // CRC-16/MODBUS (polinom 0xA001, başlangıç 0xFFFF)
+        public static ushort Crc16(ReadOnlySpan<byte> data)
+        {
+            ushort crc = 0xFFFF;
+            foreach (byte b in data)
+            {
+                crc ^= b;
+                for (int bit = 0; bit < 8; bit++)
+                    crc = (crc & 1) != 0 ? (ushort)((crc >> 1) ^ 0xA001) : (ushort)(crc >> 1);
+            }
+            return crc;
+        }
+    }
+
+    // Cihaz başına son kaydedilen örnekler (toplu gönderimde topluluğun sonuncusu); delta
+    // çerçevelerin tabanı. Cihaz bir yanıtı kaçırırsa eski bir tabana göre yazabileceği için
+    // birkaç örnek saklanır. Kaydedilen en büyük sıra numarası da tutulur: yanıtı kaybolan
+    // gönderim tekrarlandığında bu sıraya kadar olan çerçeveler yeniden yazılmaz. Cihazın sıra
+    // numarası yalnızca NVS silinince (yeniden yükleme, fabrika ayarı) geri gider. Sunucu yeniden
+    // başlarsa boşalır; o durumda delta 409 ile reddedilir ve cihaz tam çerçeve gönderir.
+    public sealed class TelemetryStateCache
+    {
+        private const int HistoryLength = 4;
+
+        // Son örnekler eklenme sırasıyla döner; en eskinin üzerine yazılır
+        private sealed class DeviceHistory
+        {
+            public readonly (uint Sequence, TelemetrySample? Sample)[] Entries = new (uint, TelemetrySample?)[HistoryLength];
+            public int Next;
+            public uint LastSequence;
+            public bool HasLast;
+        }
+
+        private readonly ConcurrentDictionary<uint, DeviceHistory> _devices = new();
+
+        public bool TryGet(uint deviceId, uint sequence, out TelemetrySample sample)
+        {
+            sample = null!;
+            if (!_devices.TryGetValue(deviceId, out var history))
+                return false;
+
+            lock (history)
+            {
+                foreach (var entry in history.Entries)
+                {
+                    if (entry.Sample != null && entry.Sequence == sequence)
+                    {
+                        sample = entry.Sample;
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        // Bu sıra numarası daha önce kaydedildi mi. Cihaz yalnızca onaylanmamış topluluğu
+        // tekrar gönderir; son kayıttan bir topluluktan fazla geride kalan sıra numarası cihazın
+        // sıfırlandığını gösterir. O durumda cihazın geçmişi silinir ve çerçeve yeni sayılır;
+        // yoksa sunucu yeniden başlayana kadar tüm çerçeveler tekrar sayılıp atılırdı.
+        public bool IsStored(uint deviceId, uint sequence)
+        {
+            if (!_devices.TryGetValue(deviceId, out var history))
+                return false;
+
+            lock (history)
+            {
+                if (!history.HasLast || sequence > history.LastSequence)
+                    return false;
+                if (history.LastSequence - sequence < TelemetryFrameDecoder.MaxBatchFrames)
+                    return true;
+
+                Array.Clear(history.Entries);
+                history.Next = 0;
+                history.LastSequence = 0;
+                history.HasLast = false;
+                return false;
+            }
+        }
+
+        public void Store(uint deviceId, uint sequence, TelemetrySample sample)
+        {
+            var history = _devices.GetOrAdd(deviceId, _ => new DeviceHistory());
+            lock (history)
+            {
+                history.Entries[history.Next] = (sequence, sample);
+                history.Next = (history.Next + 1) % HistoryLength;
+                if (!history.HasLast || sequence > history.LastSequence)
+                {
+                    history.LastSequence = sequence;
+                    history.HasLast = true;
+                }
+            }
+        }
+    }
+}
@@ -17,6 +17,9 @@ builder.Services.AddDbContext<AppDbContext>(options =>
 
 // Parola hashleme servisini ekle
 builder.Services.AddScoped<IPasswordHasher<User>, PasswordHasher<User>>();
+
+// İkili telemetri: cihaz başına delta tabanları (bellekte)
+builder.Services.AddSingleton<TelemetryStateCache>();
 // ⚠️ ou <Users> si ton modèle est bien Users
 
 // Authentification cookie